@@ -5,6 +5,8 @@
 // https://www.boost.org/LICENSE_1_0.txt
 
 #include <boost/locale.hpp>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <set>
 #include <string>
@@ -12,10 +14,88 @@
 
 using namespace boost::locale;
 
+namespace {
+    typedef std::chrono::steady_clock clock_type;
+
+    /// Create a UTF-8 text of at least \a size bytes mixing ASCII, Latin and Hebrew words
+    std::string make_text(size_t size)
+    {
+        char const *const words[] = { "hello ", "grüßen ", "שלום ", "conversion ", "€ " };
+        std::string text;
+        for(size_t i = 0; text.size() < size; i++)
+            text += words[i % (sizeof(words) / sizeof(words[0]))];
+        return text;
+    }
+
+    /// Run \a f repeatedly for about 0.2 seconds and print the throughput of \a input_size bytes per call
+    template<typename Function>
+    void measure(char const *name,size_t input_size,Function f)
+    {
+        size_t rounds = 0;
+        clock_type::time_point const start = clock_type::now();
+        double elapsed;
+        do {
+            f();
+            rounds++;
+            elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+        } while(elapsed < 0.2);
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << input_size
+                  << std::setw(10) << std::fixed << std::setprecision(1) << input_size * rounds / elapsed / 1e6
+                  << " MB/s" << std::endl;
+    }
+
+    int charset_performance()
+    {
+        std::cout << std::left << std::setw(40) << "conversion" << std::right << std::setw(10) << "bytes"
+                  << std::setw(15) << "throughput" << std::endl;
+        size_t const sizes[] = { 64, 6 * 1024, 1024 * 1024 };
+        for(size_t size : sizes) {
+            std::string const utf8 = make_text(size);
+            std::wstring const wide = conv::utf_to_utf<wchar_t>(utf8);
+            std::string const utf16 = conv::between(utf8,"UTF-16LE","UTF-8");
+            std::string const latin1 = conv::from_utf(utf8,"ISO-8859-1");
+
+            measure("to_utf<wchar_t> from UTF-8",utf8.size(),[&]() {
+                conv::to_utf<wchar_t>(utf8,"UTF-8");
+            });
+            measure("from_utf<wchar_t> to UTF-8",utf8.size(),[&]() {
+                conv::from_utf(wide,"UTF-8");
+            });
+            measure("between UTF-8 to UTF-16LE",utf8.size(),[&]() {
+                conv::between(utf8,"UTF-16LE","UTF-8");
+            });
+            measure("between UTF-16LE to UTF-8",utf16.size(),[&]() {
+                conv::between(utf16,"UTF-8","UTF-16LE");
+            });
+            measure("to_utf<char> from ISO-8859-1",latin1.size(),[&]() {
+                conv::to_utf<char>(latin1,"ISO-8859-1");
+            });
+
+            conv::between_converter to_utf16("UTF-16LE","UTF-8");
+            measure("between_converter::convert",utf8.size(),[&]() {
+                to_utf16.convert(utf8);
+            });
+            std::string output;
+            measure("between_converter::convert_into",utf8.size(),[&]() {
+                to_utf16.convert_into(utf8,output);
+            });
+            conv::utf_decoder<wchar_t> decoder("UTF-8");
+            std::wstring wide_output;
+            measure("utf_decoder<wchar_t>::convert_into",utf8.size(),[&]() {
+                decoder.convert_into(utf8,wide_output);
+            });
+        }
+        return 0;
+    }
+}
+
 int main(int argc,char **argv)
 {
-    if(argc!=2) {
-        std::cerr << "Usage backend locale\n";
+    if(argc==2 && std::string(argv[1])=="charset")
+        return charset_performance();
+    if(argc!=3) {
+        std::cerr << "Usage: backend locale  - convert the case of the lines read from the standard input\n"
+                  << "       charset         - measure the throughput of the charset conversions\n";
         return 1;
     }
     /// Set global locale to requested
@@ -0,0 +1,491 @@
+//
+// Copyright (c) 2026 agent
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+//
+// Benchmark of the message catalogs: creates synthetic mo files of different sizes, features and encodings
+// and measures loading, memory, lookups, plural forms and multi-threaded lookups of char and wchar_t facets.
+// The results are written as JSON to the standard output.
+//
+
+#include <boost/locale.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+using namespace boost::locale;
+
+namespace {
+
+    typedef std::chrono::steady_clock clock_type;
+
+    double seconds_since(clock_type::time_point start)
+    {
+        return std::chrono::duration<double>(clock_type::now() - start).count();
+    }
+
+    void make_dir(std::string const &path)
+    {
+        #ifdef _WIN32
+        _mkdir(path.c_str());
+        #else
+        mkdir(path.c_str(),0777);
+        #endif
+    }
+
+    //
+    // Description of a synthetic catalog
+    //
+    struct catalog_spec {
+        unsigned size;
+        bool mixed;         // Every 7th message has a context and every 10th plural forms
+        bool hash;          // Write a hash table
+        std::string charset;
+
+        std::string name() const
+        {
+            std::ostringstream ss;
+            ss << "m" << size << (mixed ? "_mixed" : "_simple") << (hash ? "_hash" : "_nohash") << "_";
+            for(size_t i = 0;i < charset.size();i++) {
+                if(charset[i] != '-')
+                    ss << char(tolower(charset[i]));
+            }
+            return ss.str();
+        }
+    };
+
+    struct message_key {
+        std::string context;
+        std::string id;
+        std::string plural;
+    };
+
+    message_key key_of(catalog_spec const &spec,unsigned i)
+    {
+        message_key k;
+        std::ostringstream ss;
+        ss << "message number " << i << " with some text";
+        k.id = ss.str();
+        if(spec.mixed && i % 10 == 0)
+            k.plural = k.id + "s";
+        else if(spec.mixed && i % 7 == 0) {
+            std::ostringstream ctx;
+            ctx << "context " << i % 5;
+            k.context = ctx.str();
+        }
+        return k;
+    }
+
+    uint32_t pjw_hash(std::string const &s)
+    {
+        uint32_t h = 0;
+        for(size_t i = 0;i < s.size();i++) {
+            h = (h << 4) + static_cast<unsigned char>(s[i]);
+            uint32_t g = h & 0xF0000000u;
+            if(g)
+                h = (h ^ (g >> 24)) ^ g;
+        }
+        return h;
+    }
+
+    uint32_t next_prime(uint32_t n)
+    {
+        for(;;n++) {
+            bool prime = n > 1;
+            for(uint32_t d = 2;prime && d * d <= n;d++)
+                prime = n % d != 0;
+            if(prime)
+                return n;
+        }
+    }
+
+    //
+    // Write the mo file like msgfmt does: sorted keys and a hash table of 4/3 of the number of messages
+    //
+    void write_mo(catalog_spec const &spec,std::string const &file_name)
+    {
+        struct entry {
+            std::string key;        // As stored, with the plural id after a NUL
+            std::string lookup_key; // As hashed, context\4id
+            std::string value;
+            bool operator<(entry const &other) const { return key < other.key; }
+        };
+        std::vector<entry> entries;
+        entry header;
+        header.value = "Content-Type: text/plain; charset=" + spec.charset + "\n"
+                       "Plural-Forms: nplurals=3; plural=n%10==1 && n%100!=11 ? 0 : n%10>=2 && n%10<=4 && (n%100<10 || n%100>=20) ? 1 : 2;\n";
+        entries.push_back(header);
+        for(unsigned i = 1;i < spec.size;i++) {
+            message_key k = key_of(spec,i);
+            entry e;
+            e.lookup_key = k.context.empty() ? k.id : k.context + '\4' + k.id;
+            e.key = k.plural.empty() ? e.lookup_key : e.lookup_key + '\0' + k.plural;
+            std::ostringstream ss;
+            ss << "traduction numéro " << i << " avec du texte";
+            std::string value = ss.str();
+            if(!k.plural.empty())
+                value = value + " un" + '\0' + value + " quelques" + '\0' + value + " beaucoup";
+            e.value = conv::from_utf(value,spec.charset);
+            entries.push_back(e);
+        }
+        std::sort(entries.begin(),entries.end());
+
+        uint32_t const n = uint32_t(entries.size());
+        uint32_t const hash_size = spec.hash ? next_prime(n * 4 / 3 + 3) : 0;
+        uint32_t const keys_offset = 28;
+        uint32_t const values_offset = keys_offset + 8 * n;
+        uint32_t const hash_offset = values_offset + 8 * n;
+        uint32_t data_offset = hash_offset + 4 * hash_size;
+
+        std::vector<uint32_t> head = { 0x950412de, 0, n, keys_offset, values_offset, hash_size, hash_offset };
+        std::vector<uint32_t> keys,values,table(hash_size);
+        std::string data;
+        for(uint32_t i = 0;i < n;i++) {
+            keys.push_back(uint32_t(entries[i].key.size()));
+            keys.push_back(data_offset + uint32_t(data.size()));
+            data += entries[i].key + '\0';
+        }
+        for(uint32_t i = 0;i < n;i++) {
+            values.push_back(uint32_t(entries[i].value.size()));
+            values.push_back(data_offset + uint32_t(data.size()));
+            data += entries[i].value + '\0';
+        }
+        for(uint32_t i = 0;i < hash_size && i < n;i++) {
+            uint32_t h = pjw_hash(entries[i].lookup_key);
+            uint32_t incr = 1 + h % (hash_size - 2);
+            uint32_t pos = h % hash_size;
+            while(table[pos] != 0)
+                pos = (pos + incr) % hash_size;
+            table[pos] = i + 1;
+        }
+        std::ofstream f(file_name.c_str(),std::ios::binary);
+        f.write(reinterpret_cast<char const *>(head.data()),4 * head.size());
+        f.write(reinterpret_cast<char const *>(keys.data()),4 * keys.size());
+        f.write(reinterpret_cast<char const *>(values.data()),4 * values.size());
+        f.write(reinterpret_cast<char const *>(table.data()),4 * table.size());
+        f.write(data.data(),data.size());
+        if(!f)
+            throw std::runtime_error("Failed to write " + file_name);
+    }
+
+    //
+    // Minimal JSON writer, the values are added in order
+    //
+    class json {
+    public:
+        json(): first_(true) {}
+
+        void begin(std::string const &name,char bracket)
+        {
+            key(name);
+            out_ << bracket;
+            first_ = true;
+        }
+
+        void end(char bracket)
+        {
+            out_ << bracket;
+            first_ = false;
+        }
+
+        template<typename T>
+        void value(std::string const &name,T const &v)
+        {
+            key(name);
+            out_ << v;
+        }
+
+        void value(std::string const &name,std::string const &v)
+        {
+            key(name);
+            out_ << '"' << v << '"';
+        }
+
+        void value(std::string const &name,bool v)
+        {
+            key(name);
+            out_ << (v ? "true" : "false");
+        }
+
+        std::string str() const
+        {
+            return out_.str();
+        }
+
+    private:
+        void key(std::string const &name)
+        {
+            if(!first_)
+                out_ << ',';
+            first_ = false;
+            if(!name.empty())
+                out_ << '"' << name << "\":";
+        }
+
+        std::ostringstream out_;
+        bool first_;
+    };
+
+    template<typename Char>
+    std::basic_string<Char> widen(std::string const &s)
+    {
+        return conv::utf_to_utf<Char>(s);
+    }
+
+    template<typename Char>
+    struct lookup_keys {
+        std::vector<std::basic_string<Char> > contexts;
+        std::vector<std::basic_string<Char> > ids;
+        std::vector<bool> plural;
+
+        lookup_keys(catalog_spec const &spec,unsigned first,unsigned count,unsigned seed)
+        {
+            std::vector<unsigned> order;
+            for(unsigned i = 0;i < count;i++)
+                order.push_back(first + i);
+            // Random order, so the lookups don't walk the catalog sequentially
+            srand(seed);
+            for(size_t i = order.size();i > 1;i--)
+                std::swap(order[i - 1],order[rand() % i]);
+            for(size_t i = 0;i < order.size();i++) {
+                message_key k = key_of(spec,order[i]);
+                contexts.push_back(widen<Char>(k.context));
+                ids.push_back(widen<Char>(k.id));
+                plural.push_back(!k.plural.empty());
+            }
+        }
+
+        Char const *context(size_t i) const
+        {
+            return contexts[i].empty() ? 0 : contexts[i].c_str();
+        }
+    };
+
+    //
+    // Run f(i) for rounds * keys lookups and return the nanoseconds per lookup
+    //
+    template<typename F>
+    double time_lookups(size_t keys,unsigned rounds,F f)
+    {
+        size_t found = 0;
+        clock_type::time_point start = clock_type::now();
+        for(unsigned r = 0;r < rounds;r++) {
+            for(size_t i = 0;i < keys;i++)
+                found += f(i) ? 1 : 0;
+        }
+        double elapsed = seconds_since(start);
+        // Make sure the lookups are not optimized away
+        if(found == size_t(-1))
+            std::cerr << found;
+        return elapsed * 1e9 / (double(keys) * rounds);
+    }
+
+    template<typename Char>
+    void bench_facet(json &out,std::string const &name,catalog_spec const &spec,std::locale const &l,
+                     unsigned lookups,std::vector<unsigned> const &threads)
+    {
+        message_format<Char> const &facet = std::use_facet<message_format<Char> >(l);
+        int const domain = facet.domain(spec.name());
+        unsigned const count = std::min(lookups,spec.size - 1);
+        unsigned const rounds = std::max(1u,lookups / count);
+        lookup_keys<Char> hits(spec,1,count,1);
+        lookup_keys<Char> misses(spec,spec.size,count,2);
+
+        out.begin(name,'{');
+        out.value("hit_ns",time_lookups(count,rounds,[&](size_t i) {
+            return facet.get(domain,hits.context(i),hits.ids[i].c_str()) != 0;
+        }));
+        out.value("miss_ns",time_lookups(count,rounds,[&](size_t i) {
+            return facet.get(domain,misses.context(i),misses.ids[i].c_str()) != 0;
+        }));
+        if(spec.mixed) {
+            std::vector<size_t> plurals;
+            for(size_t i = 0;i < count;i++) {
+                if(hits.plural[i])
+                    plurals.push_back(i);
+            }
+            // Every 10th message has plural forms, too few lookups may not hit any of them
+            if(!plurals.empty()) {
+                out.value("plural_ns",time_lookups(plurals.size(),rounds,[&](size_t i) {
+                    size_t k = plurals[i];
+                    return facet.get(domain,hits.context(k),hits.ids[k].c_str(),int(i % 1200)) != 0;
+                }));
+            }
+        }
+
+        out.begin("threads",'[');
+        for(size_t t = 0;t < threads.size();t++) {
+            std::atomic<size_t> found(0);
+            std::vector<std::thread> workers;
+            clock_type::time_point start = clock_type::now();
+            for(unsigned w = 0;w < threads[t];w++) {
+                workers.push_back(std::thread([&,w]() {
+                    size_t n = 0;
+                    for(unsigned r = 0;r < rounds;r++) {
+                        for(size_t i = 0;i < count;i++) {
+                            size_t k = (i + w * 7919) % count;
+                            n += facet.get(domain,hits.context(k),hits.ids[k].c_str()) != 0;
+                        }
+                    }
+                    found += n;
+                }));
+            }
+            for(size_t w = 0;w < workers.size();w++)
+                workers[w].join();
+            double elapsed = seconds_since(start);
+            out.begin("",'{');
+            out.value("threads",threads[t]);
+            out.value("lookups_per_second",double(found) / elapsed);
+            out.end('}');
+        }
+        out.end(']');
+        out.end('}');
+    }
+
+    std::vector<unsigned> parse_list(std::string const &s)
+    {
+        std::vector<unsigned> result;
+        std::istringstream ss(s);
+        std::string item;
+        while(std::getline(ss,item,','))
+            result.push_back(unsigned(atoi(item.c_str())));
+        return result;
+    }
+
+    void usage()
+    {
+        std::cerr <<
+            "Usage: perf_messages [-d directory] [-s sizes] [-c charsets] [-t threads] [-l lookups]\n"
+            "\n"
+            "  -d  directory for the generated catalogs, default perf_messages_data\n"
+            "  -s  comma separated catalog sizes, default 1000,50000,500000\n"
+            "  -c  comma separated catalog encodings, default UTF-8,ISO-8859-1\n"
+            "  -t  comma separated thread counts, default 1,2,4,8\n"
+            "  -l  number of lookups of each measurement (at least 1), default 1000000\n"
+            "\n"
+            "The plural_ns result is left out if no plural message is looked up.\n";
+    }
+
+} // anon
+
+int main(int argc,char **argv)
+{
+    std::string dir = "perf_messages_data";
+    std::vector<unsigned> sizes = { 1000, 50000, 500000 };
+    std::vector<std::string> charsets = { "UTF-8", "ISO-8859-1" };
+    std::vector<unsigned> threads = { 1, 2, 4, 8 };
+    unsigned lookups = 1000000;
+    for(int i = 1;i < argc;i++) {
+        std::string arg = argv[i];
+        if(i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if(arg == "-d")
+            dir = value;
+        else if(arg == "-s")
+            sizes = parse_list(value);
+        else if(arg == "-t")
+            threads = parse_list(value);
+        else if(arg == "-l")
+            lookups = unsigned(atoi(value.c_str()));
+        else if(arg == "-c") {
+            charsets.clear();
+            std::istringstream ss(value);
+            std::string item;
+            while(std::getline(ss,item,','))
+                charsets.push_back(item);
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if(lookups == 0) {
+        std::cerr << "The number of lookups must be positive" << std::endl;
+        return 1;
+    }
+
+    std::vector<catalog_spec> specs;
+    for(size_t s = 0;s < sizes.size();s++) {
+        for(size_t c = 0;c < charsets.size();c++) {
+            for(int mixed = 0;mixed < 2;mixed++) {
+                for(int hash = 1;hash >= 0;hash--) {
+                    catalog_spec spec = { std::max(sizes[s],2u), mixed != 0, hash != 0, charsets[c] };
+                    specs.push_back(spec);
+                }
+            }
+        }
+    }
+
+    make_dir(dir);
+    make_dir(dir + "/fr");
+    make_dir(dir + "/fr/LC_MESSAGES");
+
+    json out;
+    out.begin("",'{');
+    out.value("hardware_concurrency",std::thread::hardware_concurrency());
+    out.begin("catalogs",'[');
+    try {
+        for(size_t i = 0;i < specs.size();i++) {
+            catalog_spec const &spec = specs[i];
+            std::string file_name = dir + "/fr/LC_MESSAGES/" + spec.name() + ".mo";
+            write_mo(spec,file_name);
+            std::cerr << spec.name() << std::endl;
+
+            {
+                generator gen;
+                gen.add_messages_path(dir);
+                gen.add_messages_domain(spec.name());
+                gen.categories(message_facet);
+                gen.characters(char_facet | wchar_t_facet);
+
+                size_t const memory_before = gnu_gettext::get_catalog_store_stats().memory;
+                clock_type::time_point start = clock_type::now();
+                std::locale l = gen("fr_FR.UTF-8");
+                double const load = seconds_since(start);
+                size_t const memory_after = gnu_gettext::get_catalog_store_stats().memory;
+
+                out.begin("",'{');
+                out.value("name",spec.name());
+                out.value("messages",spec.size);
+                out.value("mixed",spec.mixed);
+                out.value("hash_table",spec.hash);
+                out.value("charset",spec.charset);
+                out.value("load_seconds",load);
+                out.value("memory_bytes",memory_after > memory_before ? memory_after - memory_before : 0);
+                bench_facet<char>(out,"char",spec,l,lookups,threads);
+                bench_facet<wchar_t>(out,"wchar_t",spec,l,lookups,threads);
+                out.end('}');
+            }
+            // The locale using the file is gone, so it can be removed on all systems
+            std::remove(file_name.c_str());
+        }
+    }
+    catch(std::exception const &e) {
+        std::cerr << "Failed: " << e.what() << std::endl;
+        return 1;
+    }
+    out.end(']');
+    out.end('}');
+    std::cout << out.str() << std::endl;
+    return 0;
+}
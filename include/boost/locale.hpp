@@ -20,6 +20,7 @@
 #include <boost/locale/info.hpp>
 #include <boost/locale/localization_backend.hpp>
 #include <boost/locale/message.hpp>
+#include <boost/locale/message_ids.hpp>
 #include <boost/locale/util.hpp>
 
 #endif
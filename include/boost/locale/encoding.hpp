@@ -11,6 +11,7 @@
 #include <boost/locale/info.hpp>
 #include <boost/locale/encoding_errors.hpp>
 #include <boost/locale/encoding_utf.hpp>
+#include <boost/locale/hold_ptr.hpp>
 
 #ifdef BOOST_MSVC
 #  pragma warning(push)
@@ -198,6 +199,190 @@ namespace boost {
 
             /// \cond INTERNAL
 
+            namespace impl {
+                class converter_between;
+                class converter_incremental;
+                template<typename CharType>
+                class converter_from_utf;
+                template<typename CharType>
+                class converter_to_utf;
+            }
+
+            /// \endcond
+
+            ///
+            /// \brief Converter of texts from one encoding to another that is opened once and used for many texts
+            ///
+            /// Opening a converter costs much more than converting a short text, so prefer this class over \ref between
+            /// when converting many texts between the same encodings. An object must not be used by several threads
+            /// at once.
+            ///
+            class BOOST_LOCALE_DECL between_converter {
+            public:
+                ///
+                /// Create a converter to \a to_encoding from \a from_encoding according to policy \a how
+                ///
+                /// \throws invalid_charset_error if either encoding is not supported
+                ///
+                between_converter(std::string const &to_encoding,std::string const &from_encoding,method_type how=default_method);
+                ~between_converter();
+
+                ///
+                /// Convert the text in range [begin,end)
+                ///
+                std::string convert(char const *begin,char const *end);
+                ///
+                /// Convert a \a text
+                ///
+                std::string convert(std::string const &text)
+                {
+                    return convert(text.c_str(),text.c_str()+text.size());
+                }
+                ///
+                /// Convert the text in range [begin,end) replacing the content of \a output
+                ///
+                /// The storage of \a output is reused, so converting many texts to the same string avoids
+                /// allocating memory for each of them. \a output must not hold the text being converted.
+                ///
+                void convert_into(char const *begin,char const *end,std::string &output);
+                ///
+                /// Convert a \a text replacing the content of \a output
+                ///
+                void convert_into(std::string const &text,std::string &output)
+                {
+                    convert_into(text.c_str(),text.c_str()+text.size(),output);
+                }
+            private:
+                hold_ptr<impl::converter_between> cvt_;
+            };
+
+            ///
+            /// \brief Converter of a text given in chunks from one encoding to another, for example read from a stream
+            ///
+            /// A multibyte sequence split between two chunks is kept by the converter and completed by the next chunk.
+            /// The output is written to a buffer provided by the caller, when it is full the conversion stops and
+            /// continues from the same place with the next call. It requires iconv or ICU support. An object must not
+            /// be used by several threads at once.
+            ///
+            class BOOST_LOCALE_DECL incremental_converter {
+            public:
+                ///
+                /// Create a converter to \a to_encoding from \a from_encoding according to policy \a how
+                ///
+                /// \throws invalid_charset_error if either encoding is not supported
+                ///
+                incremental_converter(std::string const &to_encoding,std::string const &from_encoding,method_type how=default_method);
+                ~incremental_converter();
+
+                ///
+                /// Convert the chunk [begin,end) to the buffer [out,out_end). \a begin is advanced past the input
+                /// consumed and \a out past the output written.
+                ///
+                /// Returns false if the output buffer is full before the whole chunk is consumed, true otherwise.
+                ///
+                /// \throws conversion_error if the text is invalid and \a how is \ref stop
+                ///
+                bool convert(char const *&begin,char const *end,char *&out,char *out_end);
+                ///
+                /// Complete the conversion at the end of the text writing the remaining output to [out,out_end).
+                /// \a out is advanced past the output written.
+                ///
+                /// Returns false if the output buffer is full, call it again with a new buffer in this case. After it
+                /// returns true the converter can be used for a new text.
+                ///
+                /// \throws conversion_error if the text ends with an incomplete sequence and \a how is \ref stop
+                ///
+                bool finish(char *&out,char *out_end);
+            private:
+                hold_ptr<impl::converter_incremental> cvt_;
+            };
+
+            ///
+            /// \brief Converter of UTF texts to texts encoded with a given charset, the reusable counterpart of \ref from_utf
+            ///
+            /// An object must not be used by several threads at once.
+            ///
+            template<typename CharType>
+            class BOOST_LOCALE_DECL utf_encoder {
+            public:
+                ///
+                /// Create a converter from UTF to \a charset according to policy \a how
+                ///
+                /// \throws invalid_charset_error if \a charset is not supported
+                ///
+                utf_encoder(std::string const &charset,method_type how=default_method);
+                ~utf_encoder();
+
+                ///
+                /// Convert the UTF text in range [begin,end)
+                ///
+                std::string convert(CharType const *begin,CharType const *end);
+                ///
+                /// Convert a UTF \a text
+                ///
+                std::string convert(std::basic_string<CharType> const &text)
+                {
+                    return convert(text.c_str(),text.c_str()+text.size());
+                }
+                ///
+                /// Convert the UTF text in range [begin,end) replacing the content of \a output, reusing its storage
+                ///
+                void convert_into(CharType const *begin,CharType const *end,std::string &output);
+                ///
+                /// Convert a UTF \a text replacing the content of \a output, reusing its storage
+                ///
+                void convert_into(std::basic_string<CharType> const &text,std::string &output)
+                {
+                    convert_into(text.c_str(),text.c_str()+text.size(),output);
+                }
+            private:
+                hold_ptr<impl::converter_from_utf<CharType> > cvt_;
+            };
+
+            ///
+            /// \brief Converter of texts encoded with a given charset to UTF texts, the reusable counterpart of \ref to_utf
+            ///
+            /// An object must not be used by several threads at once.
+            ///
+            template<typename CharType>
+            class BOOST_LOCALE_DECL utf_decoder {
+            public:
+                ///
+                /// Create a converter from \a charset to UTF according to policy \a how
+                ///
+                /// \throws invalid_charset_error if \a charset is not supported
+                ///
+                utf_decoder(std::string const &charset,method_type how=default_method);
+                ~utf_decoder();
+
+                ///
+                /// Convert the text in range [begin,end)
+                ///
+                std::basic_string<CharType> convert(char const *begin,char const *end);
+                ///
+                /// Convert a \a text
+                ///
+                std::basic_string<CharType> convert(std::string const &text)
+                {
+                    return convert(text.c_str(),text.c_str()+text.size());
+                }
+                ///
+                /// Convert the text in range [begin,end) replacing the content of \a output, reusing its storage
+                ///
+                void convert_into(char const *begin,char const *end,std::basic_string<CharType> &output);
+                ///
+                /// Convert a \a text replacing the content of \a output, reusing its storage
+                ///
+                void convert_into(std::string const &text,std::basic_string<CharType> &output)
+                {
+                    convert_into(text.c_str(),text.c_str()+text.size(),output);
+                }
+            private:
+                hold_ptr<impl::converter_to_utf<CharType> > cvt_;
+            };
+
+            /// \cond INTERNAL
+
             template<>
             BOOST_LOCALE_DECL std::basic_string<char> to_utf(char const *begin,char const *end,std::string const &charset,method_type how);
 
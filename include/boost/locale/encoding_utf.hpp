@@ -31,21 +31,40 @@ namespace boost {
             std::basic_string<CharOut>
             utf_to_utf(CharIn const *begin,CharIn const *end,method_type how = default_method)
             {
+                // The result is at most as long as the input unless converting to a narrower encoding
+                const bool may_grow = sizeof(CharOut) < sizeof(CharIn);
+                const int max_width = utf::utf_traits<CharOut>::max_width;
+
                 std::basic_string<CharOut> result;
-                result.reserve(end-begin);
-                typedef std::back_insert_iterator<std::basic_string<CharOut> > inserter_type;
-                inserter_type inserter(result);
-                utf::code_point c;
+                result.resize(end-begin);
+                CharOut *out = &result[0];
+                CharOut *out_end = out + result.size();
                 while(begin!=end) {
+BOOST_LOCALE_START_CONST_CONDITION
+                    if(may_grow && out_end - out < max_width) {
+                        size_t size = out - &result[0];
+                        result.resize(result.size() + (end - begin) + max_width);
+                        out = &result[0] + size;
+                        out_end = &result[0] + result.size();
+                    }
+BOOST_LOCALE_END_CONST_CONDITION
+                    // ASCII is the same in all UTF encodings, the cast makes negative units invalid code points
+                    utf::code_point c = static_cast<utf::code_point>(*begin);
+                    if(c < 0x80) {
+                        *out++ = static_cast<CharOut>(c);
+                        begin++;
+                        continue;
+                    }
                     c=utf::utf_traits<CharIn>::template decode<CharIn const *>(begin,end);
                     if(c==utf::illegal || c==utf::incomplete) {
                         if(how==stop)
                             throw conversion_error();
                     }
                     else {
-                        utf::utf_traits<CharOut>::template encode<inserter_type>(c,inserter);
+                        out = utf::utf_traits<CharOut>::template encode<CharOut *>(c,out);
                     }
                 }
+                result.resize(out - &result[0]);
                 return result;
             }
 
@@ -183,6 +183,32 @@ namespace boost {
             ///
             void use_ansi_encoding(bool enc);
 
+            ///
+            /// Check if message catalogs that require conversion are converted on first use. The default is false.
+            ///
+            bool lazy_message_conversion() const;
+
+            ///
+            /// Convert the messages of catalogs that can't be used as-is (wide character facets or catalogs
+            /// in a different encoding) on their first use rather than converting the entire catalog
+            /// when the locale is generated.
+            ///
+            /// This reduces the startup time and the memory use when an application uses only a small part
+            /// of large catalogs, at the cost of a slower first lookup of each message.
+            ///
+            void lazy_message_conversion(bool lazy);
+
+            ///
+            /// Check if the statistics of message lookups are collected. The default is false.
+            ///
+            bool message_statistics() const;
+
+            ///
+            /// Collect statistics of the message lookups of each generated locale, they can be accessed
+            /// using the gnu_gettext::message_statistics_facet of the locale.
+            ///
+            void message_statistics(bool enabled);
+
             ///
             /// Generate a locale with id \a id
             ///
@@ -8,8 +8,12 @@
 #define BOOST_LOCLAE_GNU_GETTEXT_HPP
 
 #include <boost/locale/message.hpp>
+#include <boost/locale/hold_ptr.hpp>
 #include <stdexcept>
 #include <functional>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace boost {
@@ -23,6 +27,104 @@ namespace locale {
 ///
 namespace gnu_gettext {
 
+    ///
+    /// \brief Statistics of the message lookups in one domain
+    ///
+    struct message_domain_stats {
+        static const int probe_buckets = 8;     ///< Size of the probes histogram
+
+        std::string name;                       ///< The name of the domain
+        unsigned long long lookups;             ///< Number of messages looked up
+        unsigned long long hits;                ///< Number of messages found in the catalog
+        unsigned long long misses;              ///< Number of messages not found in the catalog
+        unsigned long long plural_evaluations;  ///< Number of plural forms selected using the plural expression
+        ///
+        /// Lookups in catalogs used directly from their mo file by the number of probes of its hash table:
+        /// probes[i] counts the lookups that needed i+1 probes, the last element also all longer ones
+        ///
+        unsigned long long probes[probe_buckets];
+        ///
+        /// Sample of messages that were not found as pairs of context and id converted to UTF-8,
+        /// the number of different messages recorded is limited
+        ///
+        std::vector<std::pair<std::string,std::string> > missing;
+    };
+
+    ///
+    /// \brief Statistics of the message lookups in a locale
+    ///
+    struct message_stats {
+        unsigned long long key_conversions;         ///< Number of original strings converted to the locale encoding
+        unsigned long long cached_key_conversions;  ///< Number of these conversions taken from the cache of converted strings
+        std::vector<message_domain_stats> domains;  ///< Statistics of each domain
+    };
+
+    ///
+    /// \brief Collector of the statistics of the message lookups of the facets created with it
+    ///
+    /// The counters are updated using relaxed atomic operations, so the statistics are cheap enough
+    /// to be enabled in production but are only approximately consistent while lookups are running.
+    ///
+    /// \see generator::message_statistics, message_statistics_facet, messages_info::statistics
+    ///
+    class BOOST_LOCALE_DECL message_statistics {
+        message_statistics(message_statistics const &);
+        void operator=(message_statistics const &);
+    public:
+        message_statistics();
+        ~message_statistics();
+
+        ///
+        /// Get the statistics recorded so far
+        ///
+        message_stats get() const;
+        ///
+        /// Reset all counters and the sample of missing messages
+        ///
+        void reset();
+
+        /// \cond INTERNAL
+        struct domain_counters;
+        domain_counters &domain(std::string const &name);
+        void add_key_conversion(bool cached);
+        /// \endcond
+    private:
+        struct data;
+        hold_ptr<data> d;
+    };
+
+    ///
+    /// \brief Facet giving access to the message statistics of a locale
+    ///
+    /// It is installed by the backends together with the message_format facets if
+    /// generator::message_statistics is enabled.
+    ///
+    class BOOST_LOCALE_DECL message_statistics_facet : public std::locale::facet {
+    public:
+        static std::locale::id id; ///< The facet id
+
+        ///
+        /// Create a facet giving access to \a statistics
+        ///
+        message_statistics_facet(std::shared_ptr<message_statistics> const &statistics,size_t refs = 0):
+            std::locale::facet(refs),
+            statistics_(statistics)
+        {
+        }
+        ~message_statistics_facet();
+
+        ///
+        /// Get the statistics collector
+        ///
+        message_statistics &statistics() const
+        {
+            return *statistics_;
+        }
+
+    private:
+        std::shared_ptr<message_statistics> statistics_;
+    };
+
     ///
     /// \brief This structure holds all information required for creating gnu-gettext message catalogs,
     ///
@@ -32,7 +134,7 @@ namespace gnu_gettext {
     /// ignore gettext catalogs that use a charset different from \a encoding.
     ///
     struct messages_info {
-        messages_info(): language("C"), locale_category("LC_MESSAGES") {}
+        messages_info(): language("C"), locale_category("LC_MESSAGES"), lazy_conversion(false) {}
 
         std::string language;   ///< The language we load the catalog for, like "ru", "en", "de"
         std::string country;    ///< The country we load the catalog for, like "US", "IL"
@@ -40,6 +142,9 @@ namespace gnu_gettext {
         std::string encoding;   ///< Required target charset encoding. Ignored for wide characters.
                                 ///< For narrow, should specify the correct encoding required for this catalog
         std::string locale_category; ///< Locale category, is set by default to LC_MESSAGES, but may be changed
+        bool lazy_conversion;   ///< Convert messages of catalogs that can't be used directly on their first use
+                                ///< instead of converting entire catalogs when they are loaded
+        std::shared_ptr<message_statistics> statistics; ///< If set, the lookups are recorded in it
         ///
         /// \brief This type represents GNU Gettext domain name for the messages.
         ///
@@ -104,6 +209,9 @@ namespace gnu_gettext {
         /// - If the file does not exist, it should return an empty vector.
         /// - If a error occurs during file read it should throw a error.
         ///
+        /// It is called only by the thread creating the facet, one file at a time. The catalogs of multiple
+        /// domains are loaded concurrently only when the callback is not set.
+        ///
         /// \note The user should support only the encodings the locales are created for. So if the user
         /// uses only one encoding or the file system is encoding agnostic, he may ignore the \a encoding parameter.
         ///
@@ -130,6 +238,25 @@ namespace gnu_gettext {
     template<typename CharType>
     message_format<CharType> *create_messages_facet(messages_info const &info);
 
+    ///
+    /// \brief Statistics of the process wide store of loaded message catalogs
+    ///
+    /// Catalogs read from the file system are shared between all facets created for the same file
+    /// (identified by its canonical path, modification time and size), character type and encodings
+    /// as long as any of these facets exists. Catalogs loaded using messages_info::callback are not shared.
+    ///
+    struct catalog_store_stats {
+        size_t catalogs;            ///< Number of catalogs currently held in the store
+        size_t memory;              ///< Approximate memory used by these catalogs in bytes
+        unsigned long long hits;    ///< Number of lookups that found an already loaded catalog
+        unsigned long long misses;  ///< Number of lookups that required loading a catalog
+    };
+
+    ///
+    /// Get the current statistics of the process wide catalog store
+    ///
+    BOOST_LOCALE_DECL catalog_store_stats get_catalog_store_stats();
+
     /// \cond INTERNAL
 
     template<>
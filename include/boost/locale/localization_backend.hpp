@@ -37,6 +37,10 @@ namespace boost {
         ///     by default
         /// -# \c message_path - path to the location of message catalogs (vector of strings)
         /// -# \c message_application - the name of applications that use message catalogs (vector of strings)
+        /// -# \c message_lazy_conversion - convert messages on their first use rather than when the catalogs
+        ///     are loaded, "true" or "false"
+        /// -# \c message_statistics - collect statistics of the message lookups, see gnu_gettext::message_statistics_facet,
+        ///     "true" or "false"
         ///
         /// Each backend can be installed with a different default priotiry so when you work with two different backends, you
         /// can specify priotiry so this backend will be chosen according to their priority.
@@ -12,6 +12,8 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #ifdef BOOST_MSVC
 #  pragma warning(push)
@@ -41,8 +43,94 @@ namespace boost {
         template<typename CharType>
         struct base_message_format;
 
+        namespace details {
+            // Compile time version of the PJW hash used by GNU Gettext catalogs
+            constexpr uint32_t pj_winberger_hash_mix(uint32_t value)
+            {
+                return (value & 0xF0000000U) != 0
+                    ? (value ^ ((value & 0xF0000000U) >> 24)) ^ (value & 0xF0000000U)
+                    : value;
+            }
+            #ifndef BOOST_NO_CXX14_CONSTEXPR
+            constexpr uint32_t pj_winberger_hash_update(uint32_t state,char const *str)
+            {
+                for(;*str;str++)
+                    state = pj_winberger_hash_mix((state << 4) + static_cast<unsigned char>(*str));
+                return state;
+            }
+            #else
+            // C++11 constexpr functions can't loop. Recursing once per character would exceed the
+            // nesting limit of the compilers (usually 512) for long strings, so the string is hashed
+            // in chunks: the nesting is about length / chunk + chunk calls deep.
+            static const unsigned pj_winberger_hash_chunk = 64;
+
+            constexpr uint32_t pj_winberger_hash_update_n(uint32_t state,char const *str,unsigned n)
+            {
+                return n == 0 || *str == 0
+                    ? state
+                    : pj_winberger_hash_update_n(pj_winberger_hash_mix((state << 4) + static_cast<unsigned char>(*str)),str + 1,n - 1);
+            }
+            constexpr bool pj_winberger_hash_has_more(char const *str,unsigned n)
+            {
+                return n == 0 || (*str != 0 && pj_winberger_hash_has_more(str + 1,n - 1));
+            }
+            constexpr uint32_t pj_winberger_hash_update(uint32_t state,char const *str)
+            {
+                return pj_winberger_hash_has_more(str,pj_winberger_hash_chunk)
+                    ? pj_winberger_hash_update(pj_winberger_hash_update_n(state,str,pj_winberger_hash_chunk),str + pj_winberger_hash_chunk)
+                    : pj_winberger_hash_update_n(state,str,pj_winberger_hash_chunk);
+            }
+            #endif
+        } // details
+
         /// \endcond
 
+        ///
+        /// \brief Precomputed hash of a message key, i.e. of the context and the original (singular) string
+        ///
+        /// It allows the message catalogs to start the lookup without hashing the key at run time, only the final
+        /// comparison touches the string. Create it at compile time using \ref hash_message_key or the
+        /// \ref BOOST_LOCALE_TRANSLATE family of macros.
+        ///
+        /// \note Only narrow character catalogs make use of it, for other character types it is ignored.
+        ///
+        class message_key_hash {
+        public:
+            ///
+            /// Create from the \a value returned by \ref hash_message_key
+            ///
+            constexpr explicit message_key_hash(uint32_t value): value_(value) {}
+            ///
+            /// Get the hash value
+            ///
+            constexpr uint32_t value() const { return value_; }
+        private:
+            uint32_t value_;
+        };
+
+        ///
+        /// Calculate the hash of message key \a id without context
+        ///
+        /// \note Before C++14 the compile time evaluation recurses once per 64 characters, so keys of
+        /// more than about 28000 characters may exceed the constexpr nesting limit of the compiler.
+        ///
+        constexpr message_key_hash hash_message_key(char const *id)
+        {
+            return message_key_hash(details::pj_winberger_hash_update(0,id));
+        }
+
+        ///
+        /// Calculate the hash of message key \a id in context \a context
+        ///
+        constexpr message_key_hash hash_message_key(char const *context,char const *id)
+        {
+            return message_key_hash(details::pj_winberger_hash_update(
+                        details::pj_winberger_hash_update(
+                            details::pj_winberger_hash_update(0,context),
+                            "\4"), // EOT
+                        id));
+        }
+
         ///
         /// \brief This facet provides message formatting abilities
         ///
@@ -91,6 +179,56 @@ namespace boost {
             ///
             virtual char_type const *get(int domain_id,char_type const *context,char_type const *single_id,int n) const = 0;
 
+            ///
+            /// Same as get(domain_id,context,id) but uses the precomputed \a hash of the key
+            /// that must be the hash of \a context and \a id as returned by \ref hash_message_key
+            ///
+            /// The default implementation ignores the hash
+            ///
+            virtual char_type const *get_hashed(int domain_id,char_type const *context,char_type const *id,message_key_hash /*hash*/) const
+            {
+                return get(domain_id,context,id);
+            }
+
+            ///
+            /// Same as get(domain_id,context,single_id,n) but uses the precomputed \a hash of the key
+            /// that must be the hash of \a context and \a single_id as returned by \ref hash_message_key
+            ///
+            /// The default implementation ignores the hash
+            ///
+            virtual char_type const *get_hashed(int domain_id,char_type const *context,char_type const *single_id,int n,message_key_hash /*hash*/) const
+            {
+                return get(domain_id,context,single_id,n);
+            }
+
+            ///
+            /// Get all plural forms of the translation of the message defined by \a context and \a id in a domain
+            /// defined by \a domain_id and store pointers to them in \a forms. They stay valid as long as the facet exists.
+            ///
+            /// If the message isn't translated false is returned
+            ///
+            /// The default implementation stores the result of get(domain_id,context,id) only
+            ///
+            virtual bool get_forms(int domain_id,char_type const *context,char_type const *id,std::vector<char_type const *> &forms) const
+            {
+                char_type const *translated = get(domain_id,context,id);
+                if(!translated)
+                    return false;
+                forms.push_back(translated);
+                return true;
+            }
+
+            ///
+            /// Get the index of the plural form for the number \a n in a domain defined by \a domain_id
+            /// as used by get(domain_id,context,single_id,n)
+            ///
+            /// The default implementation returns -1, which means that the facet can't provide it
+            ///
+            virtual int plural_form(int /*domain_id*/,int /*n*/) const
+            {
+                return -1;
+            }
+
             ///
             /// Convert a string that defines \a domain to the integer id used by \a get functions
             ///
@@ -100,6 +238,8 @@ namespace boost {
             /// Convert the string \a msg to target locale's encoding. If \a msg is already
             /// in target encoding it would be returned otherwise the converted
             /// string is stored in temporary \a buffer and buffer.c_str() is returned.
+            /// An implementation may also return a converted string it keeps, valid as long
+            /// as the facet exists.
             ///
             /// Note: for char_type that is char16_t, char32_t and wchar_t it is no-op, returns
             /// msg
@@ -157,6 +297,77 @@ namespace boost {
 
         /// \endcond
 
+        ///
+        /// \brief A message domain resolved for a specific locale
+        ///
+        /// Translating a message into a domain given by its name looks up the messages facet of the locale and the id
+        /// of the domain on each call. The handle does both once, so it can be created once per locale and domain and
+        /// be passed to basic_message::str, basic_message::view or \ref as::domain instead of the name.
+        ///
+        template<typename CharType>
+        class basic_domain_handle {
+        public:
+            typedef message_format<CharType> facet_type; ///< The type of the facet the messages are fetched with
+
+            ///
+            /// Create a handle of the default domain of locale \a loc
+            ///
+            explicit basic_domain_handle(std::locale const &loc): locale_(loc), facet_(0), id_(0)
+            {
+                if(std::has_facet<facet_type>(locale_))
+                    facet_ = &std::use_facet<facet_type>(locale_);
+            }
+            ///
+            /// Create a handle of the domain \a domain of locale \a loc
+            ///
+            basic_domain_handle(std::locale const &loc,std::string const &domain): locale_(loc), facet_(0), id_(0)
+            {
+                if(std::has_facet<facet_type>(locale_)) {
+                    facet_ = &std::use_facet<facet_type>(locale_);
+                    id_ = facet_->domain(domain);
+                }
+            }
+
+            ///
+            /// Get the locale the domain was resolved for
+            ///
+            std::locale const &locale() const { return locale_; }
+            ///
+            /// Get the messages facet of the locale or NULL if it has none
+            ///
+            facet_type const *facet() const { return facet_; }
+            ///
+            /// Get the id of the domain as returned by message_format::domain
+            ///
+            int id() const { return id_; }
+
+        private:
+            std::locale locale_;
+            facet_type const *facet_;
+            int id_;
+        };
+
+        ///
+        /// Convenience typedef for char
+        ///
+        typedef basic_domain_handle<char> domain_handle;
+        ///
+        /// Convenience typedef for wchar_t
+        ///
+        typedef basic_domain_handle<wchar_t> wdomain_handle;
+        #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+        ///
+        /// Convenience typedef for char16_t
+        ///
+        typedef basic_domain_handle<char16_t> u16domain_handle;
+        #endif
+        #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+        ///
+        /// Convenience typedef for char32_t
+        ///
+        typedef basic_domain_handle<char32_t> u32domain_handle;
+        #endif
+
         ///
         /// \brief This class represents a message that can be converted to a specific locale message
         ///
@@ -175,13 +386,13 @@ namespace boost {
             ///
             /// Create default empty message
             ///
-            basic_message(): n_(0), c_id_(0), c_context_(0), c_plural_(0) {}
+            basic_message(): n_(0), c_id_(0), c_context_(0), c_plural_(0), hash_(0), has_hash_(false) {}
 
             ///
             /// Create a simple message from 0 terminated string. The string should exist
             /// until the message is destroyed. Generally useful with static constant strings
             ///
-            explicit basic_message(char_type const *id): n_(0), c_id_(id), c_context_(0), c_plural_(0) {}
+            explicit basic_message(char_type const *id): n_(0), c_id_(id), c_context_(0), c_plural_(0), hash_(0), has_hash_(false) {}
 
             ///
             /// Create a simple plural form message from 0 terminated strings. The strings should exist
@@ -193,7 +404,9 @@ namespace boost {
                 n_(n),
                 c_id_(single),
                 c_context_(0),
-                c_plural_(plural)
+                c_plural_(plural),
+                hash_(0),
+                has_hash_(false)
             {}
 
             ///
@@ -205,7 +418,9 @@ namespace boost {
                 n_(0),
                 c_id_(id),
                 c_context_(context),
-                c_plural_(0)
+                c_plural_(0),
+                hash_(0),
+                has_hash_(false)
             {}
 
             ///
@@ -218,7 +433,25 @@ namespace boost {
                 n_(n),
                 c_id_(single),
                 c_context_(context),
-                c_plural_(plural)
+                c_plural_(plural),
+                hash_(0),
+                has_hash_(false)
+            {}
+
+            ///
+            /// Create a message from 0 terminated strings with a precomputed \a hash of the key.
+            /// \a context and \a plural may be NULL.
+            ///
+            /// The strings should exist until the message is destroyed. \a hash must be the value returned by
+            /// \ref hash_message_key for \a context and \a id, otherwise the message will not be found.
+            ///
+            basic_message(message_key_hash hash,char_type const *context,char_type const *id,char_type const *plural = 0,int n = 0):
+                n_(n),
+                c_id_(id),
+                c_context_(context),
+                c_plural_(plural),
+                hash_(hash.value()),
+                has_hash_(true)
             {}
 
 
@@ -230,6 +463,8 @@ namespace boost {
                 c_id_(0),
                 c_context_(0),
                 c_plural_(0),
+                hash_(0),
+                has_hash_(false),
                 id_(id)
             {}
 
@@ -243,6 +478,8 @@ namespace boost {
                 c_id_(0),
                 c_context_(0),
                 c_plural_(0),
+                hash_(0),
+                has_hash_(false),
                 id_(single),
                 plural_(plural)
             {}
@@ -255,6 +492,8 @@ namespace boost {
                 c_id_(0),
                 c_context_(0),
                 c_plural_(0),
+                hash_(0),
+                has_hash_(false),
                 id_(id),
                 context_(context)
             {}
@@ -269,6 +508,8 @@ namespace boost {
                 c_id_(0),
                 c_context_(0),
                 c_plural_(0),
+                hash_(0),
+                has_hash_(false),
                 id_(single),
                 context_(context),
                 plural_(plural)
@@ -282,6 +523,8 @@ namespace boost {
                 c_id_(other.c_id_),
                 c_context_(other.c_context_),
                 c_plural_(other.c_plural_),
+                hash_(other.hash_),
+                has_hash_(other.has_hash_),
                 id_(other.id_),
                 context_(other.context_),
                 plural_(other.plural_)
@@ -305,6 +548,8 @@ namespace boost {
                 std::swap(c_id_,other.c_id_);
                 std::swap(c_context_,other.c_context_);
                 std::swap(c_plural_,other.c_plural_);
+                std::swap(hash_,other.hash_);
+                std::swap(has_hash_,other.has_hash_);
 
                 id_.swap(other.id_);
                 context_.swap(other.context_);
@@ -361,6 +606,18 @@ namespace boost {
             }
 
 
+            ///
+            /// Translate message to a string using the locale and message domain of \a domain
+            ///
+            string_type str(basic_domain_handle<char_type> const &domain) const
+            {
+                string_type buffer;
+                char_type const *ptr = write(domain.facet(),domain.id(),buffer);
+                if(ptr != buffer.c_str())
+                    buffer = ptr;
+                return buffer;
+            }
+
             ///
             /// Translate message to a string using locale \a loc and message domain index  \a id
             ///
@@ -376,6 +633,53 @@ namespace boost {
             }
 
 
+            ///
+            /// Translate message using locale \a loc and default domain without copying the result
+            ///
+            /// See view(std::locale const &,int,string_type &) for details
+            ///
+            char_type const *view(std::locale const &loc,string_type &buffer) const
+            {
+                return view(loc,0,buffer);
+            }
+
+            ///
+            /// Translate message using locale \a loc and message domain \a domain_id without copying the result
+            ///
+            /// See view(std::locale const &,int,string_type &) for details
+            ///
+            char_type const *view(std::locale const &loc,std::string const &domain_id,string_type &buffer) const
+            {
+                int id=0;
+                if(std::has_facet<facet_type>(loc))
+                    id=std::use_facet<facet_type>(loc).domain(domain_id);
+                return view(loc,id,buffer);
+            }
+
+            ///
+            /// Translate message using locale \a loc and message domain index \a id without copying the result
+            ///
+            /// Returns a pointer to the NUL terminated translation stored in the catalog, valid as long as \a loc exists.
+            /// If the message isn't translated a pointer to the original string is returned, which is owned by this
+            /// object if it was created from std::basic_string. Only if the original string needs to be converted to
+            /// the encoding of the locale the result is stored in \a buffer and buffer.c_str() is returned, or the
+            /// converted string cached by the locale is returned.
+            ///
+            char_type const *view(std::locale const &loc,int id,string_type &buffer) const
+            {
+                return write(loc,id,buffer);
+            }
+
+            ///
+            /// Translate message using the locale and message domain of \a domain without copying the result
+            ///
+            /// See view(std::locale const &,int,string_type &) for details
+            ///
+            char_type const *view(basic_domain_handle<char_type> const &domain,string_type &buffer) const
+            {
+                return write(domain.facet(),domain.id(),buffer);
+            }
+
             ///
             /// Translate message and write to stream \a out, using imbued locale and domain set to the
             /// stream
@@ -412,6 +716,14 @@ namespace boost {
             }
 
             char_type const *write(std::locale const &loc,int domain_id,string_type &buffer) const
+            {
+                facet_type const *facet = 0;
+                if(std::has_facet<facet_type>(loc))
+                    facet = &std::use_facet<facet_type>(loc);
+                return write(facet,domain_id,buffer);
+            }
+
+            char_type const *write(facet_type const *facet,int domain_id,string_type &buffer) const
             {
                 char_type const *translated = 0;
                 static const char_type empty_string[1] = {0};
@@ -423,12 +735,14 @@ namespace boost {
                 if(*id == 0)
                     return empty_string;
 
-                facet_type const *facet = 0;
-                if(std::has_facet<facet_type>(loc))
-                    facet = &std::use_facet<facet_type>(loc);
-
                 if(facet) {
-                    if(!plural) {
+                    if(has_hash_) {
+                        if(!plural)
+                            translated = facet->get_hashed(domain_id,context,id,message_key_hash(hash_));
+                        else
+                            translated = facet->get_hashed(domain_id,context,id,n_,message_key_hash(hash_));
+                    }
+                    else if(!plural) {
                         translated = facet->get(domain_id,context,id);
                     }
                     else {
@@ -455,6 +769,8 @@ namespace boost {
             char_type const *c_id_;
             char_type const *c_context_;
             char_type const *c_plural_;
+            uint32_t hash_;
+            bool has_hash_;
             string_type id_;
             string_type context_;
             string_type plural_;
@@ -482,6 +798,151 @@ namespace boost {
         typedef basic_message<char32_t> u32message;
         #endif
 
+        ///
+        /// \brief This class translates many messages at once using the same locale and domain
+        ///
+        /// The message facet and the domain are looked up only once when the object is created, so
+        /// translating a group of messages, for example all strings of a page template, costs one catalog lookup
+        /// per message. Translations found in the catalog are returned as pointers into it without copying them.
+        ///
+        /// \note The object refers to the facet of the locale it was created with, so the locale must outlive it.
+        ///
+        template<typename CharType>
+        class basic_message_batch {
+        public:
+
+            typedef CharType char_type; ///< The character this object is used with
+            typedef std::basic_string<char_type> string_type; ///< The string type this object can be used with
+            typedef message_format<char_type> facet_type; ///< The type of the facet the messages are fetched with
+
+            ///
+            /// \brief A message to translate, the strings are not copied
+            ///
+            struct request {
+                char_type const *context;   ///< The context or NULL if the message has none
+                char_type const *id;        ///< The original (singular) string
+                char_type const *plural;    ///< The plural form or NULL if the message has none
+                int n;                      ///< The number to select the plural form with
+            };
+
+            ///
+            /// Create an object translating messages of the default domain in locale \a loc
+            ///
+            basic_message_batch(std::locale const &loc): facet_(0), domain_id_(0)
+            {
+                if(std::has_facet<facet_type>(loc))
+                    facet_ = &std::use_facet<facet_type>(loc);
+            }
+
+            ///
+            /// Create an object translating messages of the domain \a domain in locale \a loc
+            ///
+            basic_message_batch(std::locale const &loc,std::string const &domain): facet_(0), domain_id_(0)
+            {
+                if(std::has_facet<facet_type>(loc)) {
+                    facet_ = &std::use_facet<facet_type>(loc);
+                    domain_id_ = facet_->domain(domain);
+                }
+            }
+
+            ///
+            /// Create an object translating messages of the locale and domain of \a domain
+            ///
+            explicit basic_message_batch(basic_domain_handle<char_type> const &domain):
+                facet_(domain.facet()),
+                domain_id_(domain.id())
+            {
+            }
+
+            ///
+            /// Translate \a count messages given by \a requests and store pointers to the NUL terminated results in \a results
+            ///
+            /// The results point to the translations in the catalog or, if a message isn't translated, to its original
+            /// string. Original strings that need to be converted to the encoding of the locale are stored in this object,
+            /// these pointers stay valid until the next call of translate.
+            ///
+            /// Returns the number of messages found in the catalog.
+            ///
+            size_t translate(request const *requests,size_t count,char_type const **results)
+            {
+                static const char_type empty_string[1] = {0};
+                size_t found = 0;
+                bool converted = false;
+                storage_.clear();
+                for(size_t i=0;i<count;i++) {
+                    request const &r = requests[i];
+                    if(*r.id == 0) {
+                        results[i] = empty_string;
+                        continue;
+                    }
+                    char_type const *translated = 0;
+                    if(facet_) {
+                        if(r.plural)
+                            translated = facet_->get(domain_id_,r.context,r.id,r.n);
+                        else
+                            translated = facet_->get(domain_id_,r.context,r.id);
+                    }
+                    if(translated) {
+                        found++;
+                        results[i] = translated;
+                        continue;
+                    }
+                    char_type const *msg = r.plural ? ( r.n == 1 ? r.id : r.plural) : r.id;
+                    buffer_.clear();
+                    if(facet_)
+                        translated = facet_->convert(msg,buffer_);
+                    else
+                        translated = details::string_cast_traits<char_type>::cast(msg,buffer_);
+                    if(translated == msg) {
+                        results[i] = msg;
+                        continue;
+                    }
+                    // Fixed up below as the storage may still be reallocated
+                    results[i] = 0;
+                    storage_.append(translated);
+                    storage_ += char_type(0);
+                    converted = true;
+                }
+                if(converted) {
+                    char_type const *p = storage_.c_str();
+                    for(size_t i=0;i<count;i++) {
+                        if(!results[i]) {
+                            results[i] = p;
+                            p += std::char_traits<char_type>::length(p) + 1;
+                        }
+                    }
+                }
+                return found;
+            }
+
+        private:
+            facet_type const *facet_;
+            int domain_id_;
+            string_type buffer_;
+            string_type storage_;
+        };
+
+        ///
+        /// Convenience typedef for char
+        ///
+        typedef basic_message_batch<char> message_batch;
+        ///
+        /// Convenience typedef for wchar_t
+        ///
+        typedef basic_message_batch<wchar_t> wmessage_batch;
+        #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+        ///
+        /// Convenience typedef for char16_t
+        ///
+        typedef basic_message_batch<char16_t> u16message_batch;
+        #endif
+        #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+        ///
+        /// Convenience typedef for char32_t
+        ///
+        typedef basic_message_batch<char32_t> u32message_batch;
+        #endif
+
         ///
         /// Translate message \a msg and write it to stream
         ///
@@ -577,6 +1038,76 @@ namespace boost {
             return basic_message<CharType>(single,plural,n);
         }
 
+        ///
+        /// \brief Translate a message with a precomputed \a hash of the key, \a msg is not copied
+        ///
+        template<typename CharType>
+        inline basic_message<CharType> translate(message_key_hash hash,CharType const *msg)
+        {
+            return basic_message<CharType>(hash,0,msg);
+        }
+        ///
+        /// \brief Translate a message in context with a precomputed \a hash of the key, \a msg and \a context are not copied
+        ///
+        template<typename CharType>
+        inline basic_message<CharType> translate(   message_key_hash hash,
+                                                    CharType const *context,
+                                                    CharType const *msg)
+        {
+            return basic_message<CharType>(hash,context,msg);
+        }
+        ///
+        /// \brief Translate a plural message form with a precomputed \a hash of the key, \a single and \a plural are not copied
+        ///
+        template<typename CharType>
+        inline basic_message<CharType> translate(   message_key_hash hash,
+                                                    CharType const *single,
+                                                    CharType const *plural,
+                                                    int n)
+        {
+            return basic_message<CharType>(hash,0,single,plural,n);
+        }
+        ///
+        /// \brief Translate a plural message form in context with a precomputed \a hash of the key,
+        /// \a context, \a single and \a plural are not copied
+        ///
+        template<typename CharType>
+        inline basic_message<CharType> translate(   message_key_hash hash,
+                                                    CharType const *context,
+                                                    CharType const *single,
+                                                    CharType const *plural,
+                                                    int n)
+        {
+            return basic_message<CharType>(hash,context,single,plural,n);
+        }
+
+        ///
+        /// Translate narrow string literal \a msg with the hash of the key calculated at compile time
+        ///
+        #define BOOST_LOCALE_TRANSLATE(msg) \
+            ::boost::locale::translate(BOOST_LOCALE_MESSAGE_KEY_HASH(::boost::locale::hash_message_key(msg)),msg)
+        ///
+        /// Translate narrow string literal \a msg in \a context with the hash of the key calculated at compile time
+        ///
+        #define BOOST_LOCALE_TRANSLATE_CTX(context,msg) \
+            ::boost::locale::translate(BOOST_LOCALE_MESSAGE_KEY_HASH(::boost::locale::hash_message_key(context,msg)),context,msg)
+        ///
+        /// Translate plural form of narrow string literals with the hash of the key calculated at compile time
+        ///
+        #define BOOST_LOCALE_TRANSLATE_PLURAL(single,plural,n) \
+            ::boost::locale::translate(BOOST_LOCALE_MESSAGE_KEY_HASH(::boost::locale::hash_message_key(single)),single,plural,n)
+        ///
+        /// Translate plural form of narrow string literals in \a context with the hash of the key calculated at compile time
+        ///
+        #define BOOST_LOCALE_TRANSLATE_CTX_PLURAL(context,single,plural,n) \
+            ::boost::locale::translate(BOOST_LOCALE_MESSAGE_KEY_HASH(::boost::locale::hash_message_key(context,single)),context,single,plural,n)
+
+        /// \cond INTERNAL
+        // Force evaluation of the hash at compile time
+        #define BOOST_LOCALE_MESSAGE_KEY_HASH(hash) \
+            ::boost::locale::message_key_hash(std::integral_constant<uint32_t,(hash).value()>::value)
+        /// \endcond
+
         /// @}
 
         ///
@@ -732,6 +1263,16 @@ namespace boost {
                     ios_info::get(out).domain_id(id);
                     return out;
                 }
+
+                struct set_domain_id {
+                    int id;
+                };
+                template<typename CharType>
+                std::basic_ostream<CharType>& operator<<(std::basic_ostream<CharType> &out, set_domain_id const &dom)
+                {
+                    ios_info::get(out).domain_id(dom.id);
+                    return out;
+                }
             } // details
             /// \endcond
 
@@ -756,6 +1297,23 @@ namespace boost {
                 details::set_domain tmp = { id };
                 return tmp;
             }
+
+            ///
+            /// Manipulator for switching message domain in ostream to a domain resolved before
+            ///
+            /// \note The stream must use the locale \a domain was created for
+            ///
+            template<typename CharType>
+            #ifdef BOOST_LOCALE_DOXYGEN
+            unspecified_type
+            #else
+            details::set_domain_id
+            #endif
+            domain(basic_domain_handle<CharType> const &domain)
+            {
+                details::set_domain_id tmp = { domain.id() };
+                return tmp;
+            }
             /// @}
         } // as
     } // locale
@@ -0,0 +1,272 @@
+//
+// Copyright (c) 2026 agent
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#ifndef BOOST_LOCALE_MESSAGE_IDS_HPP_INCLUDED
+#define BOOST_LOCALE_MESSAGE_IDS_HPP_INCLUDED
+
+#include <boost/locale/message.hpp>
+#include <boost/locale/encoding_utf.hpp>
+#include <cstddef>
+#include <deque>
+#include <locale>
+#include <string>
+#include <vector>
+
+namespace boost {
+    namespace locale {
+
+        ///
+        /// \addtogroup message
+        ///
+        /// @{
+
+        ///
+        /// \brief The key of a message in a \ref message_id_table
+        ///
+        struct message_id_key {
+            char const *context;    ///< The context or NULL if the message has none
+            char const *id;         ///< The original (singular) string
+            char const *plural;     ///< The plural form or NULL if the message has none
+        };
+
+        ///
+        /// \brief A table of message keys, the position of a key in the table is its integer id
+        ///
+        /// It is usually generated from a catalog by the \c message_ids tool. The table does not
+        /// copy the keys, they must stay valid as long as it or any \ref basic_message_ids "message_ids"
+        /// object created from it is used.
+        ///
+        class message_id_table {
+        public:
+            ///
+            /// Create a table of the keys of the array \a keys
+            ///
+            template<size_t N>
+            constexpr message_id_table(message_id_key const (&keys)[N]): keys_(keys), size_(N) {}
+            ///
+            /// Create a table of \a size keys starting at \a keys
+            ///
+            constexpr message_id_table(message_id_key const *keys,size_t size): keys_(keys), size_(size) {}
+
+            ///
+            /// Get the number of keys
+            ///
+            constexpr size_t size() const { return size_; }
+            ///
+            /// Get the key of the message with the integer id \a id
+            ///
+            constexpr message_id_key const &operator[](size_t id) const { return keys_[id]; }
+
+        private:
+            message_id_key const *keys_;
+            size_t size_;
+        };
+
+        /// \cond INTERNAL
+
+        namespace details {
+            template<typename CharType>
+            struct message_id_key_traits {
+                static CharType const *cast(char const *key,std::deque<std::basic_string<CharType> > &storage)
+                {
+                    if(!key)
+                        return 0;
+                    storage.push_back(conv::utf_to_utf<CharType>(key));
+                    return storage.back().c_str();
+                }
+            };
+
+            template<>
+            struct message_id_key_traits<char> {
+                static char const *cast(char const *key,std::deque<std::string> &/*unused*/)
+                {
+                    return key;
+                }
+            };
+        }
+
+        /// \endcond
+
+        ///
+        /// \brief The messages of a \ref message_id_table resolved for a locale and domain
+        ///
+        /// All messages are looked up once when the object is created, translating a message by its integer id is
+        /// an array access afterwards. Create it once per locale and keep it as long as the locale is used.
+        ///
+        /// The messages are looked up using their keys, so a table generated from an older version of the catalog
+        /// can't give wrong translations, the messages missing in the catalog are just not translated. Use
+        /// translated() to detect a table that doesn't match the catalogs.
+        ///
+        /// Keys of non-char types are converted from UTF-8.
+        ///
+        template<typename CharType>
+        class basic_message_ids {
+            basic_message_ids(basic_message_ids const &);
+            void operator=(basic_message_ids const &);
+        public:
+            typedef CharType char_type; ///< The character this object is used with
+            typedef std::basic_string<char_type> string_type; ///< The string type this object can be used with
+            typedef message_format<char_type> facet_type; ///< The type of the facet the messages are fetched with
+
+            ///
+            /// Resolve the messages of \a table in the default domain of locale \a loc
+            ///
+            basic_message_ids(std::locale const &loc,message_id_table const &table):
+                domain_(loc)
+            {
+                init(table);
+            }
+
+            ///
+            /// Resolve the messages of \a table in the domain \a domain of locale \a loc
+            ///
+            basic_message_ids(std::locale const &loc,message_id_table const &table,std::string const &domain):
+                domain_(loc,domain)
+            {
+                init(table);
+            }
+
+            ///
+            /// Resolve the messages of \a table in the locale and domain of \a domain
+            ///
+            basic_message_ids(basic_domain_handle<char_type> const &domain,message_id_table const &table):
+                domain_(domain)
+            {
+                init(table);
+            }
+
+            ///
+            /// Get the number of messages
+            ///
+            size_t size() const
+            {
+                return messages_.size();
+            }
+
+            ///
+            /// Get the number of messages translated in the catalog
+            ///
+            size_t translated() const
+            {
+                return translated_;
+            }
+
+            ///
+            /// Translate the message with the integer id \a id, which must be less than size()
+            ///
+            /// The result points to the translation or, if the message isn't translated, to its original string,
+            /// it stays valid as long as this object exists.
+            ///
+            char_type const *translate(size_t id) const
+            {
+                message const &msg = messages_[id];
+                return msg.forms_count ? forms_[msg.forms] : msg.id;
+            }
+
+            ///
+            /// Translate the plural message with the integer id \a id for the number \a n, \a id must be less than size()
+            ///
+            /// The result points to the translation or, if the message isn't translated, to its original singular
+            /// or plural string, it stays valid as long as this object exists.
+            ///
+            char_type const *translate(size_t id,int n) const
+            {
+                message const &msg = messages_[id];
+                if(msg.forms_count) {
+                    if(plural_forms_) {
+                        int form = domain_.facet()->plural_form(domain_.id(),n);
+                        if(0 <= form && unsigned(form) < msg.forms_count)
+                            return forms_[msg.forms + form];
+                    }
+                    else {
+                        char_type const *translated = domain_.facet()->get(domain_.id(),msg.key_context,msg.key_id,n);
+                        if(translated)
+                            return translated;
+                    }
+                }
+                return n == 1 || !msg.plural ? msg.id : msg.plural;
+            }
+
+        private:
+            struct message {
+                char_type const *key_context;   ///< The context in the encoding of the keys
+                char_type const *key_id;        ///< The id in the encoding of the keys
+                char_type const *id;            ///< The original string in the encoding of the locale
+                char_type const *plural;        ///< The original plural string in the encoding of the locale
+                size_t forms;                   ///< Index of the first form in forms_
+                size_t forms_count;             ///< 0 if the message isn't translated
+            };
+
+            void init(message_id_table const &table)
+            {
+                typedef details::message_id_key_traits<char_type> traits;
+                facet_type const *facet = domain_.facet();
+                plural_forms_ = facet && facet->plural_form(domain_.id(),1) >= 0;
+                translated_ = 0;
+                messages_.resize(table.size());
+                for(size_t i=0;i<table.size();i++) {
+                    message_id_key const &key = table[i];
+                    message &msg = messages_[i];
+                    msg.key_context = traits::cast(key.context,storage_);
+                    msg.key_id = traits::cast(key.id,storage_);
+                    msg.id = original(msg.key_id);
+                    msg.plural = key.plural ? original(traits::cast(key.plural,storage_)) : 0;
+                    msg.forms = forms_.size();
+                    if(facet && *msg.key_id != 0 && facet->get_forms(domain_.id(),msg.key_context,msg.key_id,forms_))
+                        translated_++;
+                    msg.forms_count = forms_.size() - msg.forms;
+                }
+            }
+
+            // The original string converted to the encoding of the locale
+            char_type const *original(char_type const *msg)
+            {
+                string_type buffer;
+                char_type const *result = domain_.facet()
+                    ? domain_.facet()->convert(msg,buffer)
+                    : details::string_cast_traits<char_type>::cast(msg,buffer);
+                if(result == msg)
+                    return msg;
+                storage_.push_back(result);
+                return storage_.back().c_str();
+            }
+
+            basic_domain_handle<char_type> domain_;
+            bool plural_forms_;
+            size_t translated_;
+            std::vector<message> messages_;
+            std::vector<char_type const *> forms_;
+            // Converted strings, a deque doesn't move its elements when growing
+            std::deque<string_type> storage_;
+        };
+
+        ///
+        /// Convenience typedef for char
+        ///
+        typedef basic_message_ids<char> message_ids;
+        ///
+        /// Convenience typedef for wchar_t
+        ///
+        typedef basic_message_ids<wchar_t> wmessage_ids;
+        #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+        ///
+        /// Convenience typedef for char16_t
+        ///
+        typedef basic_message_ids<char16_t> u16message_ids;
+        #endif
+        #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+        ///
+        /// Convenience typedef for char32_t
+        ///
+        typedef basic_message_ids<char32_t> u32message_ids;
+        #endif
+
+        /// @}
+
+    }
+}
+
+#endif
@@ -197,41 +197,32 @@ namespace utf {
 
             unsigned char lead = *p++;
 
-            // First byte is fully validated here
-            int trail_size = trail_length(lead);
-
-            if(BOOST_LOCALE_UNLIKELY(trail_size < 0))
-                return illegal;
-
-            //
-            // Ok as only ASCII may be of size = 0
-            // also optimize for ASCII text
-            //
-            if(trail_size == 0)
+            // Optimize for ASCII text
+            if(lead < 0x80)
                 return lead;
 
-            code_point c = lead & ((1 << (6-trail_size))-1);
+            // Trail bytes, leads of overlong 2 byte sequences and of code points above 0x13FFFF
+            if(BOOST_LOCALE_UNLIKELY(lead < 0xC2 || lead > 0xF4))
+                return illegal;
 
-            // Read the rest
             unsigned char tmp;
-            switch(trail_size) {
-            case 3:
-                if(BOOST_LOCALE_UNLIKELY(p==e))
-                    return incomplete;
-                tmp = *p++;
-                if (!is_trail(tmp))
-                    return illegal;
-                c = (c << 6) | ( tmp & 0x3F);
-                BOOST_FALLTHROUGH;
-            case 2:
+
+            // 2 byte sequences are always valid once the lead is
+            if(lead < 0xE0) {
                 if(BOOST_LOCALE_UNLIKELY(p==e))
                     return incomplete;
                 tmp = *p++;
                 if (!is_trail(tmp))
                     return illegal;
-                c = (c << 6) | ( tmp & 0x3F);
-                BOOST_FALLTHROUGH;
-            case 1:
+                return ((lead & 0x1F) << 6) | (tmp & 0x3F);
+            }
+
+            code_point c;
+            if(BOOST_LOCALE_LIKELY(lead < 0xF0)) { // non-BMP rare
+                c = lead & 0x0F;
+            }
+            else {
+                c = lead & 0x07;
                 if(BOOST_LOCALE_UNLIKELY(p==e))
                     return incomplete;
                 tmp = *p++;
@@ -240,13 +231,28 @@ namespace utf {
                 c = (c << 6) | ( tmp & 0x3F);
             }
 
+            // Read the last 2 bytes
+            if(BOOST_LOCALE_UNLIKELY(p==e))
+                return incomplete;
+            tmp = *p++;
+            if (!is_trail(tmp))
+                return illegal;
+            c = (c << 6) | ( tmp & 0x3F);
+
+            if(BOOST_LOCALE_UNLIKELY(p==e))
+                return incomplete;
+            tmp = *p++;
+            if (!is_trail(tmp))
+                return illegal;
+            c = (c << 6) | ( tmp & 0x3F);
+
             // Check code point validity: no surrogates and
             // valid range
             if(BOOST_LOCALE_UNLIKELY(!is_valid_codepoint(c)))
                 return illegal;
 
             // make sure it is the most compact representation
-            if(BOOST_LOCALE_UNLIKELY(width(c)!=trail_size + 1))
+            if(BOOST_LOCALE_UNLIKELY(width(c) != (lead < 0xF0 ? 3 : 4)))
                 return illegal;
 
             return c;
@@ -8,11 +8,18 @@
 #include <boost/locale/config.hpp>
 #include <boost/locale/encoding.hpp>
 #include <boost/locale/hold_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
 #include <cstring>
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "boost/locale/encoding/conv.hpp"
+#include "boost/locale/encoding/simple_codepage.ipp"
 #if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
 #define BOOST_LOCALE_WITH_WCONV
 #endif
@@ -32,83 +39,310 @@ namespace boost {
         namespace conv {
             namespace impl {
 
-                std::string convert_between(char const *begin,
-                                            char const *end,
-                                            char const *to_charset,
-                                            char const *from_charset,
-                                            method_type how)
+                converter_between *create_between(char const *to_charset,char const *from_charset,method_type how)
                 {
-                    hold_ptr<converter_between> cvt;
+                    hold_ptr<converter_between> cvt(new simple_between());
+                    if(cvt->open(to_charset,from_charset,how))
+                        return cvt.release();
                     #ifdef BOOST_LOCALE_WITH_ICONV
                     cvt.reset(new iconv_between());
                     if(cvt->open(to_charset,from_charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
                     #endif
                     #ifdef BOOST_LOCALE_WITH_ICU
                     cvt.reset(new uconv_between());
                     if(cvt->open(to_charset,from_charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
                     #endif
                     #ifdef BOOST_LOCALE_WITH_WCONV
                     cvt.reset(new wconv_between());
                     if(cvt->open(to_charset,from_charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
+                    #endif
+                    throw invalid_charset_error(std::string(to_charset) + " or " + from_charset);
+                }
+
+                converter_incremental *create_incremental(char const *to_charset,char const *from_charset,method_type how)
+                {
+                    hold_ptr<converter_incremental> cvt;
+                    #ifdef BOOST_LOCALE_WITH_ICONV
+                    cvt.reset(new iconv_incremental());
+                    if(cvt->open(to_charset,from_charset,how))
+                        return cvt.release();
+                    #endif
+                    #ifdef BOOST_LOCALE_WITH_ICU
+                    cvt.reset(new uconv_incremental());
+                    if(cvt->open(to_charset,from_charset,how))
+                        return cvt.release();
+                    #endif
+                    #if !defined(BOOST_LOCALE_WITH_ICONV) && !defined(BOOST_LOCALE_WITH_ICU)
+                    (void)how; // Windows API conversions can't keep incomplete sequences
                     #endif
                     throw invalid_charset_error(std::string(to_charset) + " or " + from_charset);
                 }
 
                 template<typename CharType>
-                std::basic_string<CharType> convert_to(
-                                        char const *begin,
-                                        char const *end,
-                                        char const *charset,
-                                        method_type how)
+                converter_to_utf<CharType> *create_backend_to_utf(char const *charset,method_type how)
                 {
                     hold_ptr<converter_to_utf<CharType> > cvt;
                     #ifdef BOOST_LOCALE_WITH_ICONV
                     cvt.reset(new iconv_to_utf<CharType>());
                     if(cvt->open(charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
                     #endif
                     #ifdef BOOST_LOCALE_WITH_ICU
                     cvt.reset(new uconv_to_utf<CharType>());
                     if(cvt->open(charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
                     #endif
                     #ifdef BOOST_LOCALE_WITH_WCONV
                     cvt.reset(new wconv_to_utf<CharType>());
                     if(cvt->open(charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
                     #endif
                     throw invalid_charset_error(charset);
                 }
 
                 template<typename CharType>
-                std::string convert_from(
-                                        CharType const *begin,
-                                        CharType const *end,
-                                        char const *charset,
-                                        method_type how)
+                converter_to_utf<CharType> *create_to_utf(char const *charset,method_type how)
+                {
+                    hold_ptr<converter_to_utf<CharType> > cvt(new simple_to_utf<CharType>());
+                    if(cvt->open(charset,how))
+                        return cvt.release();
+                    return create_backend_to_utf<CharType>(charset,how);
+                }
+
+                template<typename CharType>
+                converter_from_utf<CharType> *create_from_utf(char const *charset,method_type how)
                 {
-                    hold_ptr<converter_from_utf<CharType> > cvt;
+                    hold_ptr<converter_from_utf<CharType> > cvt(new simple_from_utf<CharType>());
+                    if(cvt->open(charset,how))
+                        return cvt.release();
                     #ifdef BOOST_LOCALE_WITH_ICONV
                     cvt.reset(new iconv_from_utf<CharType>());
                     if(cvt->open(charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
                     #endif
                     #ifdef BOOST_LOCALE_WITH_ICU
                     cvt.reset(new uconv_from_utf<CharType>());
                     if(cvt->open(charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
                     #endif
                     #ifdef BOOST_LOCALE_WITH_WCONV
                     cvt.reset(new wconv_from_utf<CharType>());
                     if(cvt->open(charset,how))
-                        return cvt->convert(begin,end);
+                        return cvt.release();
                     #endif
                     throw invalid_charset_error(charset);
                 }
 
+                ///
+                /// The converters recently used by a thread, keyed by the normalized encodings and the method
+                ///
+                template<typename Converter>
+                class converter_cache {
+                    converter_cache(converter_cache const &);
+                    void operator=(converter_cache const &);
+                public:
+                    static constexpr size_t max_size = 8;
+
+                    converter_cache() {}
+                    ~converter_cache()
+                    {
+                        for(size_t i = 0;i < entries_.size();i++)
+                            delete entries_[i].second;
+                    }
+
+                    ///
+                    /// Get the cache of the calling thread
+                    ///
+                    static converter_cache &instance()
+                    {
+                        static thread_local converter_cache cache;
+                        return cache;
+                    }
+
+                    Converter *get(std::string const &key)
+                    {
+                        for(size_t i = 0;i < entries_.size();i++) {
+                            if(entries_[i].first == key) {
+                                std::rotate(entries_.begin(),entries_.begin() + i,entries_.begin() + i + 1);
+                                return entries_[0].second;
+                            }
+                        }
+                        return 0;
+                    }
+
+                    void add(std::string const &key,Converter *cvt)
+                    {
+                        if(entries_.size() == max_size) {
+                            delete entries_.back().second;
+                            entries_.pop_back();
+                        }
+                        entries_.insert(entries_.begin(),std::make_pair(key,cvt));
+                    }
+                private:
+                    std::vector<std::pair<std::string,Converter *> > entries_;
+                };
+
+                inline std::string cache_key(char const *charset,method_type how)
+                {
+                    std::string key = normalize_encoding(charset);
+                    key += '/';
+                    key += char('0' + how);
+                    return key;
+                }
+
+                std::string convert_between(char const *begin,
+                                            char const *end,
+                                            char const *to_charset,
+                                            char const *from_charset,
+                                            method_type how)
+                {
+                    converter_cache<converter_between> &cache = converter_cache<converter_between>::instance();
+                    std::string const key = normalize_encoding(to_charset) + '/' + cache_key(from_charset,how);
+                    converter_between *cvt = cache.get(key);
+                    if(!cvt) {
+                        hold_ptr<converter_between> created(create_between(to_charset,from_charset,how));
+                        cache.add(key,created.get());
+                        cvt = created.release();
+                    }
+                    return cvt->convert(begin,end);
+                }
+
+                template<typename CharType>
+                std::basic_string<CharType> convert_to(
+                                        char const *begin,
+                                        char const *end,
+                                        char const *charset,
+                                        method_type how)
+                {
+                    converter_cache<converter_to_utf<CharType> > &cache = converter_cache<converter_to_utf<CharType> >::instance();
+                    std::string const key = cache_key(charset,how);
+                    converter_to_utf<CharType> *cvt = cache.get(key);
+                    if(!cvt) {
+                        hold_ptr<converter_to_utf<CharType> > created(create_to_utf<CharType>(charset,how));
+                        cache.add(key,created.get());
+                        cvt = created.release();
+                    }
+                    return cvt->convert(begin,end);
+                }
+
+                template<typename CharType>
+                std::string convert_from(
+                                        CharType const *begin,
+                                        CharType const *end,
+                                        char const *charset,
+                                        method_type how)
+                {
+                    converter_cache<converter_from_utf<CharType> > &cache = converter_cache<converter_from_utf<CharType> >::instance();
+                    std::string const key = cache_key(charset,how);
+                    converter_from_utf<CharType> *cvt = cache.get(key);
+                    if(!cvt) {
+                        hold_ptr<converter_from_utf<CharType> > created(create_from_utf<CharType>(charset,how));
+                        cache.add(key,created.get());
+                        cvt = created.release();
+                    }
+                    return cvt->convert(begin,end);
+                }
+
+                namespace {
+                    char const *simple_encoding_table[] = {
+                        "cp1250",
+                        "cp1251",
+                        "cp1252",
+                        "cp1253",
+                        "cp1254",
+                        "cp1255",
+                        "cp1256",
+                        "cp1257",
+                        "iso88591",
+                        "iso885913",
+                        "iso885915",
+                        "iso88592",
+                        "iso88593",
+                        "iso88594",
+                        "iso88595",
+                        "iso88596",
+                        "iso88597",
+                        "iso88598",
+                        "iso88599",
+                        "koi8r",
+                        "koi8u",
+                        "usascii",
+                        "windows1250",
+                        "windows1251",
+                        "windows1252",
+                        "windows1253",
+                        "windows1254",
+                        "windows1255",
+                        "windows1256",
+                        "windows1257"
+                    };
+
+                    bool compare_strings(char const *l,char const *r)
+                    {
+                        return strcmp(l,r) < 0;
+                    }
+
+                    // Create the table using the conversion of each byte by the backends
+                    single_byte_table *create_single_byte_table(char const *encoding)
+                    {
+                        hold_ptr<converter_to_utf<char> > cvt;
+                        try {
+                            cvt.reset(create_backend_to_utf<char>(encoding,stop));
+                        }
+                        catch(invalid_charset_error const &/*e*/) {
+                            return 0;
+                        }
+                        utf::code_point to_unicode[256];
+                        for(unsigned i=0;i<128;i++)
+                            to_unicode[i]=i;
+                        for(unsigned i=128;i<256;i++) {
+                            char const c = static_cast<char>(i);
+                            to_unicode[i] = utf::illegal;
+                            try {
+                                std::string const utf8 = cvt->convert(&c,&c+1);
+                                char const *begin = utf8.c_str();
+                                char const *end = begin + utf8.size();
+                                utf::code_point u = utf::utf_traits<char>::decode(begin,end);
+                                if(begin == end && u != utf::illegal && u != utf::incomplete)
+                                    to_unicode[i] = u;
+                            }
+                            catch(conversion_error const &/*e*/) {
+                            }
+                        }
+                        return new single_byte_table(to_unicode);
+                    }
+                }
+
+                bool is_simple_encoding(char const *encoding)
+                {
+                    std::string norm = normalize_encoding(encoding);
+                    return std::binary_search<char const **>( simple_encoding_table,
+                                    simple_encoding_table + sizeof(simple_encoding_table)/sizeof(char const *),
+                                    norm.c_str(),
+                                    compare_strings);
+                }
+
+                std::shared_ptr<single_byte_table const> get_single_byte_table(char const *encoding)
+                {
+                    if(!is_simple_encoding(encoding))
+                        return nullptr;
+                    // The tables of the aliases of an encoding are created separately as the backends
+                    // may not support all of them
+                    static boost::mutex lock;
+                    static std::map<std::string,std::shared_ptr<single_byte_table const> > tables;
+                    std::string const name = encoding;
+                    boost::unique_lock<boost::mutex> guard(lock);
+                    std::map<std::string,std::shared_ptr<single_byte_table const> >::const_iterator p = tables.find(name);
+                    if(p != tables.end())
+                        return p->second;
+                    std::shared_ptr<single_byte_table const> table(create_single_byte_table(encoding));
+                    tables[name] = table;
+                    return table;
+                }
+
                 std::string normalize_encoding(char const *ccharset)
                 {
                     std::string charset;
@@ -130,6 +364,91 @@ namespace boost {
 
             using namespace impl;
 
+            between_converter::between_converter(std::string const &to_encoding,std::string const &from_encoding,method_type how):
+                cvt_(create_between(to_encoding.c_str(),from_encoding.c_str(),how))
+            {
+            }
+            between_converter::~between_converter()
+            {
+            }
+            std::string between_converter::convert(char const *begin,char const *end)
+            {
+                return cvt_->convert(begin,end);
+            }
+            void between_converter::convert_into(char const *begin,char const *end,std::string &output)
+            {
+                cvt_->convert_into(begin,end,output);
+            }
+
+            incremental_converter::incremental_converter(std::string const &to_encoding,std::string const &from_encoding,method_type how):
+                cvt_(create_incremental(to_encoding.c_str(),from_encoding.c_str(),how))
+            {
+            }
+            incremental_converter::~incremental_converter()
+            {
+            }
+            bool incremental_converter::convert(char const *&begin,char const *end,char *&out,char *out_end)
+            {
+                return cvt_->convert(begin,end,out,out_end);
+            }
+            bool incremental_converter::finish(char *&out,char *out_end)
+            {
+                return cvt_->finish(out,out_end);
+            }
+
+            template<typename CharType>
+            utf_encoder<CharType>::utf_encoder(std::string const &charset,method_type how):
+                cvt_(create_from_utf<CharType>(charset.c_str(),how))
+            {
+            }
+            template<typename CharType>
+            utf_encoder<CharType>::~utf_encoder()
+            {
+            }
+            template<typename CharType>
+            std::string utf_encoder<CharType>::convert(CharType const *begin,CharType const *end)
+            {
+                return cvt_->convert(begin,end);
+            }
+            template<typename CharType>
+            void utf_encoder<CharType>::convert_into(CharType const *begin,CharType const *end,std::string &output)
+            {
+                cvt_->convert_into(begin,end,output);
+            }
+
+            template<typename CharType>
+            utf_decoder<CharType>::utf_decoder(std::string const &charset,method_type how):
+                cvt_(create_to_utf<CharType>(charset.c_str(),how))
+            {
+            }
+            template<typename CharType>
+            utf_decoder<CharType>::~utf_decoder()
+            {
+            }
+            template<typename CharType>
+            std::basic_string<CharType> utf_decoder<CharType>::convert(char const *begin,char const *end)
+            {
+                return cvt_->convert(begin,end);
+            }
+            template<typename CharType>
+            void utf_decoder<CharType>::convert_into(char const *begin,char const *end,std::basic_string<CharType> &output)
+            {
+                cvt_->convert_into(begin,end,output);
+            }
+
+            template class utf_encoder<char>;
+            template class utf_decoder<char>;
+            template class utf_encoder<wchar_t>;
+            template class utf_decoder<wchar_t>;
+            #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+            template class utf_encoder<char16_t>;
+            template class utf_decoder<char16_t>;
+            #endif
+            #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+            template class utf_encoder<char32_t>;
+            template class utf_decoder<char32_t>;
+            #endif
+
             std::string between(char const *begin,char const *end,
                                 std::string const &to_charset,std::string const &from_charset,method_type how)
             {
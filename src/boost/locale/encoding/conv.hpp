@@ -71,9 +71,35 @@ namespace boost {
 
                     virtual std::string convert(char const *begin,char const *end) = 0;
 
+                    ///
+                    /// Convert [begin,end) replacing the content of \a out, engines writing directly to it reuse its storage
+                    ///
+                    virtual void convert_into(char const *begin,char const *end,std::string &out)
+                    {
+                        out = convert(begin,end);
+                    }
+
                     virtual ~converter_between() {}
                 };
 
+                class converter_incremental {
+                public:
+                    virtual bool open(char const *to_charset,char const *from_charset,method_type how) = 0;
+
+                    ///
+                    /// Convert [begin,end) to [out,out_end) keeping an incomplete sequence at the end of the input,
+                    /// return false if the output is full
+                    ///
+                    virtual bool convert(char const *&begin,char const *end,char *&out,char *out_end) = 0;
+
+                    ///
+                    /// Handle a kept incomplete sequence and return to the initial state, return false if the output is full
+                    ///
+                    virtual bool finish(char *&out,char *out_end) = 0;
+
+                    virtual ~converter_incremental() {}
+                };
+
                 template<typename CharType>
                 class converter_from_utf {
                 public:
@@ -85,6 +111,11 @@ namespace boost {
 
                     virtual std::string convert(CharType const *begin,CharType const *end) = 0;
 
+                    virtual void convert_into(CharType const *begin,CharType const *end,std::string &out)
+                    {
+                        out = convert(begin,end);
+                    }
+
                     virtual ~converter_from_utf() {}
                 };
 
@@ -99,6 +130,11 @@ namespace boost {
 
                     virtual string_type convert(char const *begin,char const *end) = 0;
 
+                    virtual void convert_into(char const *begin,char const *end,string_type &out)
+                    {
+                        out = convert(begin,end);
+                    }
+
                     virtual ~converter_to_utf() {}
                 };
             }
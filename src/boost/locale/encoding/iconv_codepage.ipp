@@ -8,7 +8,9 @@
 #define BOOST_LOCALE_IMPL_ICONV_CODEPAGE_HPP
 
 #include <boost/locale/encoding.hpp>
+#include <algorithm>
 #include <cerrno>
+#include <cstring>
 #include "boost/locale/util/iconv.hpp"
 #include "boost/locale/encoding/conv.hpp"
 
@@ -47,12 +49,21 @@ public:
     std::basic_string<OutChar> real_convert(InChar const *ubegin,InChar const *uend)
     {
         std::basic_string<OutChar> sresult;
+        real_convert(ubegin,uend,sresult);
+        return sresult;
+    }
 
-        sresult.reserve(uend - ubegin);
+    template<typename OutChar,typename InChar>
+    void real_convert(InChar const *ubegin,InChar const *uend,std::basic_string<OutChar> &sresult)
+    {
+        // Reset the shift state, a previous conversion may have stopped in the middle of a sequence
+        conv(0,0,0,0);
 
-        OutChar result[64];
+        // Convert directly to the storage of the result. Start with as many characters as the input
+        // has, which fits most texts, and grow it geometrically when iconv reports it is full.
+        sresult.resize((uend - ubegin) + 16);
+        size_t used = 0;
 
-        char *out_start   = reinterpret_cast<char *>(&result[0]);
         char const *begin = reinterpret_cast<char const *>(ubegin);
         char const *end   = reinterpret_cast<char const *>(uend);
 
@@ -60,10 +71,11 @@ public:
 
         while(state!=done) {
 
+            char *out_start = reinterpret_cast<char *>(&sresult[0] + used);
+            char *out_ptr = out_start;
             size_t in_left = end - begin;
-            size_t out_left = sizeof(result);
+            size_t out_left = (sresult.size() - used) * sizeof(OutChar);
 
-            char *out_ptr = out_start;
             size_t res = 0;
             if(in_left == 0)
                 state = unshifting;
@@ -75,7 +87,7 @@ public:
 
             int err = errno;
 
-            size_t output_count = (out_ptr - out_start) / sizeof(OutChar);
+            used += (out_ptr - out_start) / sizeof(OutChar);
 
             if(res!=0 && res!=(size_t)(-1)) {
                     if(how_ == stop) {
@@ -83,8 +95,6 @@ public:
                     }
             }
 
-            sresult.append(&result[0],output_count);
-
             if(res == (size_t)(-1)) {
                 if(err == EILSEQ || err == EINVAL) {
                     if(how_ == stop) {
@@ -101,6 +111,7 @@ public:
                     }
                 }
                 else if (err==E2BIG) {
+                    sresult.resize(sresult.size() * 2);
                     continue;
                 }
                 else {
@@ -115,7 +126,7 @@ public:
             if(state == unshifting)
                 state = done;
         }
-        return sresult;
+        sresult.resize(used);
     }
 
 
@@ -151,6 +162,11 @@ public:
     {
         return self_.template real_convert<char,char_type>(ubegin,uend);
     }
+
+    void convert_into(char_type const *ubegin,char_type const *uend,std::string &out) override
+    {
+        self_.real_convert(ubegin,uend,out);
+    }
 private:
     iconverter_base self_;
 };
@@ -166,11 +182,113 @@ public:
     {
         return self_.real_convert<char,char>(begin,end);
     }
+
+    void convert_into(char const *begin,char const *end,std::string &out) override
+    {
+        self_.real_convert(begin,end,out);
+    }
 private:
     iconverter_base self_;
 
 };
 
+class iconv_incremental : public converter_incremental
+{
+public:
+    iconv_incremental() : carry_size_(0) {}
+
+    bool open(char const *to_charset,char const *from_charset,method_type how) override
+    {
+        how_ = how;
+        carry_size_ = 0;
+        return self_.do_open(to_charset,from_charset,how);
+    }
+
+    bool convert(char const *&begin,char const *end,char *&out,char *out_end) override
+    {
+        // Complete the sequence kept from the previous chunk byte by byte
+        while(carry_size_ > 0 && begin != end) {
+            carry_[carry_size_++] = *begin++;
+            if(convert_carry(out,out_end,false) == carry_output_full) {
+                // The byte wasn't converted yet, read it again with the next call
+                carry_size_--;
+                begin--;
+                return false;
+            }
+        }
+        while(begin != end) {
+            size_t in_left = end - begin;
+            size_t out_left = out_end - out;
+            size_t res = self_.conv(&begin,&in_left,&out,&out_left);
+            if(res != (size_t)(-1)) {
+                if(res != 0 && how_ == stop)
+                    throw conversion_error();
+                continue;
+            }
+            int err = errno;
+            if(err == E2BIG)
+                return false;
+            if(err == EINVAL && size_t(end - begin) < sizeof(carry_)) {
+                // Incomplete sequence at the end of the chunk
+                std::copy(begin,end,carry_);
+                carry_size_ = end - begin;
+                begin = end;
+            }
+            else {
+                if(how_ == stop)
+                    throw conversion_error();
+                begin++;
+            }
+        }
+        return true;
+    }
+
+    bool finish(char *&out,char *out_end) override
+    {
+        if(convert_carry(out,out_end,true) == carry_output_full)
+            return false;
+        // Write the sequence returning to the initial shift state
+        size_t out_left = out_end - out;
+        return self_.conv(0,0,&out,&out_left) != (size_t)(-1);
+    }
+
+private:
+    enum carry_result { carry_done, carry_incomplete, carry_output_full };
+
+    carry_result convert_carry(char *&out,char *out_end,bool final)
+    {
+        while(carry_size_ > 0) {
+            char const *begin = carry_;
+            size_t in_left = carry_size_;
+            size_t out_left = out_end - out;
+            size_t res = self_.conv(&begin,&in_left,&out,&out_left);
+            int err = errno;
+            std::memmove(carry_,begin,in_left);
+            carry_size_ = in_left;
+            if(res != (size_t)(-1)) {
+                if(res != 0 && how_ == stop)
+                    throw conversion_error();
+                continue;
+            }
+            if(err == E2BIG)
+                return carry_output_full;
+            if(err == EINVAL && !final && carry_size_ < sizeof(carry_))
+                return carry_incomplete;
+            // Illegal sequence or incomplete one at the end of the input
+            if(how_ == stop)
+                throw conversion_error();
+            std::memmove(carry_,carry_ + 1,--carry_size_);
+        }
+        return carry_done;
+    }
+
+    iconverter_base self_;
+    method_type how_;
+    // Incomplete sequence at the end of the last chunk
+    char carry_[32];
+    size_t carry_size_;
+};
+
 template<typename CharType>
 class iconv_to_utf :  public converter_to_utf<CharType>
 {
@@ -188,6 +306,11 @@ public:
     {
         return self_.template real_convert<char_type,char>(begin,end);
     }
+
+    void convert_into(char const *begin,char const *end,string_type &out) override
+    {
+        self_.real_convert(begin,end,out);
+    }
 private:
     iconverter_base self_;
 };
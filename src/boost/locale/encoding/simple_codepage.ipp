@@ -0,0 +1,272 @@
+//
+// Copyright (c) 2026 agent
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#ifndef BOOST_LOCALE_IMPL_SIMPLE_CODEPAGE_HPP
+#define BOOST_LOCALE_IMPL_SIMPLE_CODEPAGE_HPP
+
+#include <boost/locale/encoding.hpp>
+#include <boost/locale/utf.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "boost/locale/encoding/conv.hpp"
+
+namespace boost {
+namespace locale {
+namespace conv {
+namespace impl {
+
+    ///
+    /// Mapping of a single byte encoding, like ISO-8859-x or windows-125x, from and to Unicode
+    ///
+    /// US-ASCII is mapped to itself.
+    ///
+    class single_byte_table {
+    public:
+        ///
+        /// Create the table from the code points of all bytes, utf::illegal for the bytes not used by the encoding
+        ///
+        single_byte_table(utf::code_point const (&to_unicode)[256]):
+            pages_(256,0) // The first page is for unmapped code points
+        {
+            for(unsigned i=0;i<256;i++)
+                to_unicode_[i] = to_unicode[i];
+            for(unsigned i=0;i<256;i++)
+                page_of_[i] = 0;
+            for(unsigned i=1;i<256;i++) {
+                utf::code_point u = to_unicode_[i];
+                if(u > 0xFFFF)
+                    continue;
+                unsigned high = u >> 8;
+                if(page_of_[high] == 0) {
+                    page_of_[high] = static_cast<unsigned char>(pages_.size() / 256);
+                    pages_.resize(pages_.size() + 256,0);
+                }
+                unsigned char &c = pages_[page_of_[high] * 256 + (u & 0xFF)];
+                if(c == 0)
+                    c = static_cast<unsigned char>(i);
+            }
+        }
+
+        ///
+        /// Get the code point of \a c or utf::illegal
+        ///
+        utf::code_point to_unicode(unsigned char c) const
+        {
+            return to_unicode_[c];
+        }
+
+        ///
+        /// Get the byte of \a u or -1 if \a u can't be represented in the encoding
+        ///
+        int from_unicode(utf::code_point u) const
+        {
+            if(u < 0x80)
+                return u;
+            if(u > 0xFFFF)
+                return -1;
+            unsigned char c = pages_[page_of_[u >> 8] * 256 + (u & 0xFF)];
+            return c == 0 ? -1 : c;
+        }
+
+    private:
+        utf::code_point to_unicode_[256];
+        // Two level reverse table: the page of the high byte of a BMP code point and the byte of the low one,
+        // 0 for an unmapped code point. Page 0 is the one of all unmapped high bytes.
+        unsigned char page_of_[256];
+        std::vector<unsigned char> pages_;
+    };
+
+    ///
+    /// Check if \a encoding is a single byte encoding supported by single_byte_table
+    ///
+    bool is_simple_encoding(char const *encoding);
+
+    ///
+    /// Get the process wide table of the single byte encoding \a encoding, null if it isn't one or not supported
+    ///
+    std::shared_ptr<single_byte_table const> get_single_byte_table(char const *encoding);
+
+    ///
+    /// Get the table used by the conv:: functions for \a encoding, null if the backends must be used
+    ///
+    inline std::shared_ptr<single_byte_table const> get_conversion_table(char const *encoding)
+    {
+        // The backends compose Hebrew letters and points of windows-1255 to single code points
+        std::string const norm = normalize_encoding(encoding);
+        if(norm == "cp1255" || norm == "windows1255")
+            return nullptr;
+        return get_single_byte_table(encoding);
+    }
+
+    template<typename CharType>
+    class simple_to_utf : public converter_to_utf<CharType> {
+    public:
+        typedef CharType char_type;
+        typedef std::basic_string<char_type> string_type;
+
+        bool open(char const *charset,method_type how) override
+        {
+            table_ = get_conversion_table(charset);
+            how_ = how;
+            return table_ != nullptr;
+        }
+
+        string_type convert(char const *begin,char const *end) override
+        {
+            string_type result;
+            convert_into(begin,end,result);
+            return result;
+        }
+
+        void convert_into(char const *begin,char const *end,string_type &result) override
+        {
+            // Each byte is at most 2 UTF-16 units or 3 UTF-8 units
+            result.resize((end - begin) * (4 / sizeof(char_type) < 3 ? 4 / sizeof(char_type) : 3));
+            char_type *out = &result[0];
+            while(begin != end) {
+                unsigned char c = *begin++;
+                if(c < 0x80) {
+                    *out++ = c;
+                    continue;
+                }
+                utf::code_point u = table_->to_unicode(c);
+                if(u == utf::illegal) {
+                    if(how_ == stop)
+                        throw conversion_error();
+                    continue;
+                }
+                out = utf::utf_traits<char_type>::template encode<char_type *>(u,out);
+            }
+            result.resize(out - &result[0]);
+        }
+
+    private:
+        std::shared_ptr<single_byte_table const> table_;
+        method_type how_;
+    };
+
+    template<typename CharType>
+    class simple_from_utf : public converter_from_utf<CharType> {
+    public:
+        typedef CharType char_type;
+
+        bool open(char const *charset,method_type how) override
+        {
+            table_ = get_conversion_table(charset);
+            how_ = how;
+            return table_ != nullptr;
+        }
+
+        std::string convert(char_type const *begin,char_type const *end) override
+        {
+            std::string result;
+            convert_into(begin,end,result);
+            return result;
+        }
+
+        void convert_into(char_type const *begin,char_type const *end,std::string &result) override
+        {
+            result.resize(end - begin);
+            char *out = &result[0];
+            while(begin != end) {
+                utf::code_point u = static_cast<utf::code_point>(*begin);
+                if(u < 0x80) {
+                    *out++ = static_cast<char>(u);
+                    begin++;
+                    continue;
+                }
+                u = utf::utf_traits<char_type>::template decode<char_type const *>(begin,end);
+                int c = -1;
+                if(u != utf::illegal && u != utf::incomplete)
+                    c = table_->from_unicode(u);
+                if(c < 0) {
+                    if(how_ == stop)
+                        throw conversion_error();
+                    continue;
+                }
+                *out++ = static_cast<char>(c);
+            }
+            result.resize(out - &result[0]);
+        }
+
+    private:
+        std::shared_ptr<single_byte_table const> table_;
+        method_type how_;
+    };
+
+    ///
+    /// Conversion between two single byte encodings or a single byte encoding and UTF-8
+    ///
+    class simple_between : public converter_between {
+    public:
+        bool open(char const *to_charset,char const *from_charset,method_type how) override
+        {
+            bool const to_utf8 = compare_encodings(to_charset,"UTF-8") == 0;
+            bool const from_utf8 = compare_encodings(from_charset,"UTF-8") == 0;
+            if(to_utf8 && from_utf8)
+                return false;
+            to_ = to_utf8 ? nullptr : get_conversion_table(to_charset);
+            from_ = from_utf8 ? nullptr : get_conversion_table(from_charset);
+            how_ = how;
+            return (to_ || to_utf8) && (from_ || from_utf8);
+        }
+
+        std::string convert(char const *begin,char const *end) override
+        {
+            std::string result;
+            convert_into(begin,end,result);
+            return result;
+        }
+
+        void convert_into(char const *begin,char const *end,std::string &result) override
+        {
+            result.resize((end - begin) * (to_ ? 1 : 3));
+            char *out = &result[0];
+            while(begin != end) {
+                utf::code_point u = static_cast<unsigned char>(*begin);
+                if(u < 0x80) {
+                    *out++ = static_cast<char>(u);
+                    begin++;
+                    continue;
+                }
+                if(from_) {
+                    u = from_->to_unicode(static_cast<unsigned char>(*begin++));
+                }
+                else {
+                    u = utf::utf_traits<char>::decode(begin,end);
+                    if(u == utf::incomplete)
+                        u = utf::illegal;
+                }
+                int c = u;
+                if(u != utf::illegal && to_)
+                    c = to_->from_unicode(u);
+                if(u == utf::illegal || c < 0) {
+                    if(how_ == stop)
+                        throw conversion_error();
+                    continue;
+                }
+                if(to_)
+                    *out++ = static_cast<char>(c);
+                else
+                    out = utf::utf_traits<char>::encode(u,out);
+            }
+            result.resize(out - &result[0]);
+        }
+
+    private:
+        // Null for UTF-8
+        std::shared_ptr<single_byte_table const> to_;
+        std::shared_ptr<single_byte_table const> from_;
+        method_type how_;
+    };
+
+} // impl
+} // conv
+} // locale
+} // boost
+
+#endif
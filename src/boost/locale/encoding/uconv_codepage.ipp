@@ -150,6 +150,88 @@ namespace impl {
     };
 
 
+    class uconv_incremental : public converter_incremental {
+        uconv_incremental(uconv_incremental const &);
+        void operator=(uconv_incremental const &);
+    public:
+        uconv_incremental() : from_(0), to_(0) {}
+        ~uconv_incremental()
+        {
+            close();
+        }
+
+        bool open(char const *to_charset,char const *from_charset,method_type how) override
+        {
+            close();
+            UErrorCode err = U_ZERO_ERROR;
+            from_ = ucnv_open(from_charset,&err);
+            if(U_SUCCESS(err))
+                to_ = ucnv_open(to_charset,&err);
+            if(U_SUCCESS(err)) {
+                if(how == skip) {
+                    ucnv_setToUCallBack(from_,UCNV_TO_U_CALLBACK_SKIP,0,0,0,&err);
+                    ucnv_setFromUCallBack(to_,UCNV_FROM_U_CALLBACK_SKIP,0,0,0,&err);
+                }
+                else {
+                    ucnv_setToUCallBack(from_,UCNV_TO_U_CALLBACK_STOP,0,0,0,&err);
+                    ucnv_setFromUCallBack(to_,UCNV_FROM_U_CALLBACK_STOP,0,0,0,&err);
+                }
+            }
+            if(U_FAILURE(err) || !from_ || !to_) {
+                close();
+                return false;
+            }
+            pivot_source_ = pivot_target_ = pivot_;
+            return true;
+        }
+
+        bool convert(char const *&begin,char const *end,char *&out,char *out_end) override
+        {
+            return run(begin,end,out,out_end,false);
+        }
+
+        bool finish(char *&out,char *out_end) override
+        {
+            char const *begin = "";
+            if(!run(begin,begin,out,out_end,true))
+                return false;
+            ucnv_reset(from_);
+            ucnv_reset(to_);
+            pivot_source_ = pivot_target_ = pivot_;
+            return true;
+        }
+
+    private:
+        bool run(char const *&begin,char const *end,char *&out,char *out_end,bool flush)
+        {
+            UErrorCode err = U_ZERO_ERROR;
+            // The converters keep incomplete sequences and the pivot buffer the UTF-16 text not written yet
+            ucnv_convertEx(to_,from_,&out,out_end,&begin,end,
+                           pivot_,&pivot_source_,&pivot_target_,pivot_ + sizeof(pivot_) / sizeof(pivot_[0]),
+                           false,flush,&err);
+            if(err == U_BUFFER_OVERFLOW_ERROR)
+                return false;
+            if(U_FAILURE(err))
+                throw conversion_error();
+            return true;
+        }
+
+        void close()
+        {
+            if(from_)
+                ucnv_close(from_);
+            if(to_)
+                ucnv_close(to_);
+            from_ = to_ = 0;
+        }
+
+        UConverter *from_;
+        UConverter *to_;
+        UChar pivot_[1024];
+        UChar *pivot_source_;
+        UChar *pivot_target_;
+    };
+
 } // impl
 } // conv
 } // locale
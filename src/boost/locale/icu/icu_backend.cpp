@@ -22,14 +22,17 @@ namespace locale {
 namespace impl_icu {
     class icu_localization_backend : public localization_backend {
     public:
-        icu_localization_backend(): invalid_(true), use_ansi_encoding_(false) {}
+        icu_localization_backend(): invalid_(true), use_ansi_encoding_(false), lazy_message_conversion_(false) {}
         icu_localization_backend(icu_localization_backend const &other):
             localization_backend(),
             paths_(other.paths_),
             domains_(other.domains_),
             locale_id_(other.locale_id_),
             invalid_(true),
-            use_ansi_encoding_(other.use_ansi_encoding_)
+            use_ansi_encoding_(other.use_ansi_encoding_),
+            lazy_message_conversion_(other.lazy_message_conversion_),
+            // Each copy collects its own statistics
+            message_statistics_(other.message_statistics_ ? std::make_shared<gnu_gettext::message_statistics>() : nullptr)
         {}
         icu_localization_backend *clone() const override
         {
@@ -47,12 +50,18 @@ namespace impl_icu {
                 domains_.push_back(value);
             else if(name=="use_ansi_encoding")
                 use_ansi_encoding_ = value == "true";
+            else if(name=="message_lazy_conversion")
+                lazy_message_conversion_ = value == "true";
+            else if(name=="message_statistics")
+                message_statistics_ = value == "true" ? std::make_shared<gnu_gettext::message_statistics>() : nullptr;
 
         }
         void clear_options() override
         {
             invalid_ = true;
             use_ansi_encoding_ = false;
+            lazy_message_conversion_ = false;
+            message_statistics_.reset();
             locale_id_.clear();
             paths_.clear();
             domains_.clear();
@@ -106,18 +115,23 @@ namespace impl_icu {
                     minf.encoding = data_.encoding;
                     std::copy(domains_.begin(),domains_.end(),std::back_inserter<gnu_gettext::messages_info::domains_type>(minf.domains));
                     minf.paths = paths_;
+                    minf.lazy_conversion = lazy_message_conversion_;
+                    minf.statistics = message_statistics_;
+                    std::locale messages_base = base;
+                    if(minf.statistics)
+                        messages_base = std::locale(base,new gnu_gettext::message_statistics_facet(minf.statistics));
                     switch(type) {
                     case char_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<char>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<char>(minf));
                     case wchar_t_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<wchar_t>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<wchar_t>(minf));
                     #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
                     case char16_t_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<char16_t>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<char16_t>(minf));
                     #endif
                     #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
                     case char32_t_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<char32_t>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<char32_t>(minf));
                     #endif
                     default:
                         return base;
@@ -147,6 +161,8 @@ namespace impl_icu {
         std::string real_id_;
         bool invalid_;
         bool use_ansi_encoding_;
+        bool lazy_message_conversion_;
+        std::shared_ptr<gnu_gettext::message_statistics> message_statistics_;
     };
 
     localization_backend *create_localization_backend()
@@ -28,13 +28,16 @@ namespace impl_posix {
 
     class posix_localization_backend : public localization_backend {
     public:
-        posix_localization_backend(): invalid_(true) {}
+        posix_localization_backend(): invalid_(true), lazy_message_conversion_(false) {}
         posix_localization_backend(posix_localization_backend const &other):
             localization_backend(),
             paths_(other.paths_),
             domains_(other.domains_),
             locale_id_(other.locale_id_),
-            invalid_(true)
+            invalid_(true),
+            lazy_message_conversion_(other.lazy_message_conversion_),
+            // Each copy collects its own statistics
+            message_statistics_(other.message_statistics_ ? std::make_shared<gnu_gettext::message_statistics>() : nullptr)
         {}
         posix_localization_backend *clone() const override
         {
@@ -50,11 +53,17 @@ namespace impl_posix {
                 paths_.push_back(value);
             else if(name=="message_application")
                 domains_.push_back(value);
+            else if(name=="message_lazy_conversion")
+                lazy_message_conversion_ = value == "true";
+            else if(name=="message_statistics")
+                message_statistics_ = value == "true" ? std::make_shared<gnu_gettext::message_statistics>() : nullptr;
 
         }
         void clear_options() override
         {
             invalid_ = true;
+            lazy_message_conversion_ = false;
+            message_statistics_.reset();
             locale_id_.clear();
             paths_.clear();
             domains_.clear();
@@ -133,18 +142,23 @@ namespace impl_posix {
                     minf.encoding = inf.encoding;
                     std::copy(domains_.begin(),domains_.end(),std::back_inserter<gnu_gettext::messages_info::domains_type>(minf.domains));
                     minf.paths = paths_;
+                    minf.lazy_conversion = lazy_message_conversion_;
+                    minf.statistics = message_statistics_;
+                    std::locale messages_base = base;
+                    if(minf.statistics)
+                        messages_base = std::locale(base,new gnu_gettext::message_statistics_facet(minf.statistics));
                     switch(type) {
                     case char_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<char>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<char>(minf));
                     case wchar_t_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<wchar_t>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<wchar_t>(minf));
                     #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
                     case char16_t_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<char16_t>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<char16_t>(minf));
                     #endif
                     #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
                     case char32_t_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<char32_t>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<char32_t>(minf));
                     #endif
                     default:
                         return base;
@@ -165,6 +179,8 @@ namespace impl_posix {
         std::string real_id_;
 
         bool invalid_;
+        bool lazy_message_conversion_;
+        std::shared_ptr<gnu_gettext::message_statistics> message_statistics_;
         std::shared_ptr<locale_t> lc_;
     };
 
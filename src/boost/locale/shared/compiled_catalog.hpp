@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2026 agent
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#ifndef BOOST_SRC_LOCALE_COMPILED_CATALOG_HPP_INCLUDED
+#define BOOST_SRC_LOCALE_COMPILED_CATALOG_HPP_INCLUDED
+
+#include <boost/locale/utf.hpp>
+#include <boost/cstdint.hpp>
+#include <string>
+#include <type_traits>
+
+namespace boost {
+    namespace locale {
+        namespace gnu_gettext {
+            ///
+            /// Definitions of the compiled message catalog format shared by the library
+            /// and the catalog compiler.
+            ///
+            /// The file is written in the native byte order, all numbers are uint32_t values
+            /// aligned to 4 bytes and all offsets are relative to the beginning of the file:
+            ///
+            /// - header: the fields listed by header_field
+            /// - seeds: header_buckets displacement seeds of the minimal perfect hash
+            /// - keys: header_messages pairs {offset, length} of the UTF-8 keys "context\4id" or "id",
+            ///   the keys are NUL terminated
+            /// - payloads: header_payloads records of payload_field values, one for each encoding
+            ///   the translations are stored in
+            ///
+            /// Each payload has header_messages records of entry_field values describing the translation
+            /// of the message in the same slot of the keys table. Offsets and lengths of the translations
+            /// are given in code units of the payload, translations are NUL terminated and plural forms are
+            /// separated by NUL. The offsets of plural forms following the first one are stored in the forms
+            /// table of the payload.
+            ///
+            namespace compiled {
+
+                static const uint32_t magic = 0x434D4C42; // "BLMC" in little endian
+                static const uint32_t version = 1;
+
+                enum header_field {
+                    header_magic,
+                    header_version,
+                    header_messages,
+                    header_buckets,
+                    header_seeds_offset,
+                    header_keys_offset,
+                    header_plural_offset,   ///< NUL terminated plural forms expression, 0 if not given
+                    header_flags,
+                    header_payloads,
+                    header_payloads_offset,
+                    header_size
+                };
+
+                static const uint32_t flag_ascii_keys = 1; ///< All keys are US-ASCII
+
+                enum payload_field {
+                    payload_charset_offset, ///< NUL terminated name of the encoding
+                    payload_unit_size,      ///< 1 for narrow encodings, 2 for UTF-16 and 4 for UTF-32
+                    payload_entries_offset,
+                    payload_data_offset,
+                    payload_data_size,      ///< In code units
+                    payload_forms_offset,
+                    payload_forms_size,
+                    payload_size
+                };
+
+                enum entry_field {
+                    entry_value_offset,
+                    entry_value_length,
+                    entry_forms_index,
+                    entry_forms_count,
+                    entry_size
+                };
+
+                ///
+                /// 64 bit FNV-1a hash of the code points of a key, the context is separated by EOT
+                ///
+                class key_hash {
+                public:
+                    key_hash(): state_(14695981039346656037ULL) {}
+
+                    void add(utf::code_point c)
+                    {
+                        state_ ^= c;
+                        state_ *= 1099511628211ULL;
+                    }
+
+                    template<typename CharType>
+                    void add(CharType const *begin,CharType const *end)
+                    {
+                        while(begin != end) {
+                            utf::code_point c = static_cast<typename std::make_unsigned<CharType>::type>(*begin);
+                            if(c < 0x80)
+                                ++begin;
+                            else
+                                c = utf::utf_traits<CharType>::decode(begin,end);
+                            add(c);
+                        }
+                    }
+
+                    uint64_t value() const
+                    {
+                        return state_;
+                    }
+
+                private:
+                    uint64_t state_;
+                };
+
+                template<typename CharType>
+                uint64_t hash_key(CharType const *context,CharType const *id)
+                {
+                    typedef std::char_traits<CharType> traits_type;
+                    key_hash h;
+                    if(context && *context) {
+                        h.add(context,context + traits_type::length(context));
+                        h.add(4);
+                    }
+                    h.add(id,id + traits_type::length(id));
+                    return h.value();
+                }
+
+                inline uint32_t bucket(uint64_t hash,uint32_t buckets)
+                {
+                    return uint32_t(hash >> 32) % buckets;
+                }
+
+                ///
+                /// Position of the key with \a hash in the keys table for the \a seed of its bucket
+                ///
+                inline uint32_t slot(uint64_t hash,uint32_t seed,uint32_t messages)
+                {
+                    // Finalizer of MurmurHash3, so every seed gives a different permutation
+                    uint32_t x = uint32_t(hash) ^ (seed * 0x9E3779B9u);
+                    x ^= x >> 16;
+                    x *= 0x85EBCA6Bu;
+                    x ^= x >> 13;
+                    x *= 0xC2B2AE35u;
+                    x ^= x >> 16;
+                    return x % messages;
+                }
+
+            } // compiled
+        } // gnu_gettext
+    } // locale
+} // boost
+
+#endif
@@ -22,6 +22,8 @@ namespace boost {
                 chars(all_characters),
                 caching_enabled(false),
                 use_ansi_encoding(false),
+                lazy_message_conversion(false),
+                message_statistics(false),
                 backend_manager(mgr)
             {}
 
@@ -34,6 +36,8 @@ namespace boost {
 
             bool caching_enabled;
             bool use_ansi_encoding;
+            bool lazy_message_conversion;
+            bool message_statistics;
 
             std::vector<std::string> paths;
             std::vector<std::string> domains;
@@ -160,6 +164,26 @@ namespace boost {
             d->use_ansi_encoding = v;
         }
 
+        bool generator::lazy_message_conversion() const
+        {
+            return d->lazy_message_conversion;
+        }
+
+        void generator::lazy_message_conversion(bool v)
+        {
+            d->lazy_message_conversion = v;
+        }
+
+        bool generator::message_statistics() const
+        {
+            return d->message_statistics;
+        }
+
+        void generator::message_statistics(bool v)
+        {
+            d->message_statistics = v;
+        }
+
         bool generator::locale_cache_enabled() const
         {
             return d->caching_enabled;
@@ -174,6 +198,10 @@ namespace boost {
             backend.set_option("locale",id);
             if(d->use_ansi_encoding)
                 backend.set_option("use_ansi_encoding","true");
+            if(d->lazy_message_conversion)
+                backend.set_option("message_lazy_conversion","true");
+            if(d->message_statistics)
+                backend.set_option("message_statistics","true");
             for(size_t i=0;i<d->domains.size();i++)
                 backend.set_option("message_application",d->domains[i]);
             for(size_t i=0;i<d->paths.size();i++)
@@ -9,6 +9,7 @@
 #include <boost/locale/collator.hpp>
 #include <boost/locale/conversion.hpp>
 #include <boost/locale/date_time_facet.hpp>
+#include <boost/locale/gnu_gettext.hpp>
 #include <boost/locale/info.hpp>
 #include <boost/locale/message.hpp>
 
@@ -21,6 +22,8 @@ namespace boost {
         // Make sure we have the VTable here (Export/Import issues)
         info::~info() {}
         std::locale::id calendar_facet::id;
+        std::locale::id gnu_gettext::message_statistics_facet::id;
+        gnu_gettext::message_statistics_facet::~message_statistics_facet() {}
 
         std::locale::id converter<char>::id;
         converter<char>::~converter() {}
@@ -83,6 +86,7 @@ namespace boost {
 
                     init_facet<info>(l);
                     init_facet<calendar_facet>(l);
+                    init_facet<gnu_gettext::message_statistics_facet>(l);
                 }
                 template<typename Char>
                 void init_by(const std::locale& l)
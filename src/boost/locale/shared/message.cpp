@@ -21,19 +21,42 @@
 #include <boost/locale/encoding.hpp>
 #include <boost/locale/gnu_gettext.hpp>
 #include <boost/locale/hold_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/version.hpp>
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <set>
+#include <system_error>
+#include <thread>
+#include <typeinfo>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
+#include <sys/stat.h>
+#ifndef BOOST_WINDOWS
+#  include <dirent.h>
+#endif
 
+#include "boost/locale/shared/compiled_catalog.hpp"
 #include "boost/locale/shared/mo_hash.hpp"
 #include "boost/locale/shared/mo_lambda.hpp"
 
+// Catalogs are mapped read-only into memory where possible so their pages are
+// shared between processes via the page cache instead of being copied to the heap
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__) && !defined(BOOST_LOCALE_NO_MMAP)
+#  define BOOST_LOCALE_MO_MMAP
+#  include <sys/mman.h>
+#endif
+
 #ifdef BOOST_MSVC
 #  pragma warning(disable : 4996)
 #endif
@@ -100,31 +123,346 @@ namespace boost {
 
             };
 
+            //
+            // Get a string identifying the file on disk: its canonical path, modification time and size,
+            // so a changed file is never confused with the one loaded before.
+            //
+            // Returns false if the file can't be accessed.
+            //
+            #if defined(BOOST_WINDOWS)
+
+            bool get_file_identity(std::string const &file_name,std::string const &encoding,std::string &identity)
+            {
+                std::wstring wfile_name = conv::to_utf<wchar_t>(file_name,encoding);
+                struct _stat64 st;
+                if(_wstat64(wfile_name.c_str(),&st)!=0)
+                    return false;
+                wchar_t *full_name = _wfullpath(0,wfile_name.c_str(),0);
+                if(full_name) {
+                    identity = conv::from_utf<wchar_t>(full_name,"UTF-8");
+                    free(full_name);
+                }
+                else
+                    identity = conv::from_utf(wfile_name,"UTF-8");
+                identity += '\0' + std::to_string(st.st_mtime) + '\0' + std::to_string(st.st_size);
+                return true;
+            }
+
+            #else
+
+            bool get_file_identity(std::string const &file_name,std::string const &/* encoding */,std::string &identity)
+            {
+                struct stat st;
+                if(stat(file_name.c_str(),&st)!=0)
+                    return false;
+                char *real_name = realpath(file_name.c_str(),0);
+                if(real_name) {
+                    identity = real_name;
+                    free(real_name);
+                }
+                else
+                    identity = file_name;
+                identity += '\0' + std::to_string(st.st_mtime) + '\0' + std::to_string(st.st_size);
+                return true;
+            }
+
+            #endif
+
+            //
+            // Listings of the directories searched for catalogs, read once per generated facet
+            // such that the files of all domains and fallbacks are not probed one by one.
+            //
+            class directory_cache {
+                directory_cache(directory_cache const &);
+                void operator=(directory_cache const &);
+            public:
+                directory_cache() {}
+
+                //
+                // Return false if the file \a name is known not to exist in \a dir
+                //
+                bool may_exist(std::string const &dir,std::string const &name)
+                {
+                    std::shared_ptr<names_type const> names;
+                    {
+                        boost::unique_lock<boost::mutex> guard(lock_);
+                        listings_type::const_iterator p = listings_.find(dir);
+                        if(p!=listings_.end())
+                            names = p->second;
+                        else
+                            names = listings_[dir] = read_directory(dir);
+                    }
+                    // No listing available, the file has to be probed
+                    if(!names)
+                        return true;
+                    return names->find(name) != names->end();
+                }
+
+            private:
+                typedef std::set<std::string> names_type;
+                typedef std::map<std::string,std::shared_ptr<names_type const> > listings_type;
+
+                #if defined(BOOST_WINDOWS)
+
+                static std::shared_ptr<names_type const> read_directory(std::string const &/*dir*/)
+                {
+                    // File names are not case sensitive and are given in the locale encoding, always probe
+                    return std::shared_ptr<names_type const>();
+                }
+
+                #else
+
+                static std::shared_ptr<names_type const> read_directory(std::string const &dir)
+                {
+                    std::shared_ptr<names_type> names = std::make_shared<names_type>();
+                    DIR *d = opendir(dir.c_str());
+                    if(!d) {
+                        // A directory that can't be listed may still allow access to its files
+                        if(errno == ENOENT || errno == ENOTDIR)
+                            return names;
+                        return std::shared_ptr<names_type const>();
+                    }
+                    while(dirent *e = readdir(d))
+                        names->insert(e->d_name);
+                    closedir(d);
+                    return names;
+                }
+
+                #endif
+
+                boost::mutex lock_;
+                listings_type listings_;
+            };
+
+            //
+            // Call \a f for every index in [0, n) using a small pool of threads,
+            // the first exception thrown by \a f is rethrown in the calling thread
+            //
+            template<typename Function>
+            void parallel_for(size_t n,Function f)
+            {
+                // Loading is mostly waiting for the file system, don't spawn too many threads for it
+                size_t const max_threads = 8;
+                size_t threads = std::min<size_t>(std::min<size_t>(n,max_threads),std::thread::hardware_concurrency());
+                if(threads <= 1) {
+                    for(size_t i=0;i<n;i++)
+                        f(i);
+                    return;
+                }
+                std::atomic<size_t> next(0);
+                std::vector<std::exception_ptr> errors(n);
+                auto worker = [&]() {
+                    for(size_t i; (i = next++) < n;) {
+                        try {
+                            f(i);
+                        }
+                        catch(...) {
+                            errors[i] = std::current_exception();
+                        }
+                    }
+                };
+                std::vector<std::thread> pool;
+                pool.reserve(threads);
+                try {
+                    for(size_t i=1;i<threads;i++)
+                        pool.push_back(std::thread(worker));
+                }
+                catch(std::system_error const &) {
+                    // Could not start another thread, the remaining work is done by the existing ones
+                }
+                worker();
+                for(size_t i=0;i<pool.size();i++)
+                    pool[i].join();
+                for(size_t i=0;i<n;i++) {
+                    if(errors[i])
+                        std::rethrow_exception(errors[i]);
+                }
+            }
+
+            //
+            // Content of a catalog file, mapped read-only into memory where possible
+            //
+            class file_content {
+                file_content(file_content const &);
+                void operator=(file_content const &);
+            public:
+                file_content(): data_(0), size_(0), mapped_(0) {}
+
+                ~file_content()
+                {
+                    unmap();
+                }
+
+                void assign(std::vector<char> &data)
+                {
+                    vdata_.swap(data);
+                    size_ = vdata_.size();
+                    data_ = size_ ? &vdata_[0] : 0;
+                }
+
+                void read(FILE *file)
+                {
+                    fseek(file,0,SEEK_END);
+                    long len=ftell(file);
+                    if(len < 0) {
+                        throw std::runtime_error("Wrong file object");
+                    }
+                    fseek(file,0,SEEK_SET);
+                    if(map_file(file,len))
+                        return;
+                    vdata_.resize(len+1,0); // +1 to make sure the vector is not empty
+                    if(fread(&vdata_.front(),1,len,file)!=unsigned(len))
+                        throw std::runtime_error("Failed to read file");
+                    data_ = &vdata_[0];
+                    size_ = len;
+                }
+
+                char const *data() const
+                {
+                    return data_;
+                }
+
+                size_t size() const
+                {
+                    return size_;
+                }
+
+            private:
+                bool map_file(FILE *file,long len)
+                {
+                    #ifdef BOOST_LOCALE_MO_MMAP
+                    if(len <= 0)
+                        return false;
+                    void *ptr = mmap(0,len,PROT_READ,MAP_SHARED,fileno(file),0);
+                    if(ptr == MAP_FAILED)
+                        return false;
+                    // Strings are read as 0 terminated, the copy in the vector
+                    // has an extra 0 at the end, but the mapping would not.
+                    // So require the file to be 0 terminated or fallback to reading it
+                    if(static_cast<char const *>(ptr)[len - 1] != 0) {
+                        munmap(ptr,len);
+                        return false;
+                    }
+                    mapped_ = ptr;
+                    data_ = static_cast<char const *>(ptr);
+                    size_ = len;
+                    return true;
+                    #else
+                    (void)file;
+                    (void)len;
+                    return false;
+                    #endif
+                }
+
+                void unmap()
+                {
+                    #ifdef BOOST_LOCALE_MO_MMAP
+                    if(mapped_) {
+                        munmap(mapped_,size_);
+                        mapped_ = 0;
+                    }
+                    #endif
+                }
+
+                char const *data_;
+                size_t size_;
+                std::vector<char> vdata_;
+                void *mapped_;
+            };
+
+            //
+            // Translation found in a catalog. The range [begin,end) holds all plural forms
+            // separated by NUL, forms[k] is the offset of the plural form k+1 from begin
+            //
+            template<typename CharType>
+            struct catalog_entry {
+                catalog_entry(): begin(0), end(0), forms(0), forms_count(0) {}
+                catalog_entry(CharType const *b,CharType const *e,uint32_t const *f = 0,uint32_t count = 0):
+                    begin(b), end(e), forms(f), forms_count(count)
+                {}
+
+                CharType const *form(int n) const
+                {
+                    if(!begin)
+                        return 0;
+                    CharType const *p = begin;
+                    if(n > 0) {
+                        if(unsigned(n) > forms_count)
+                            return 0;
+                        p += forms[n - 1];
+                    }
+                    if(p>=end)
+                        return 0;
+                    return p;
+                }
+
+                CharType const *begin;
+                CharType const *end;
+                uint32_t const *forms;
+                uint32_t forms_count;
+            };
+
+            //
+            // Create the index of the plural forms of a translation
+            //
+            template<typename CharType>
+            void index_plural_forms(CharType const *begin,CharType const *end,std::vector<uint32_t> &forms)
+            {
+                for(CharType const *p = begin;(p = std::find(p,end,0)) != end;)
+                    forms.push_back(uint32_t(++p - begin));
+            }
+
+            //
+            // Get the value of the field \a key of a catalog header ending with one of the \a separator characters
+            //
+            inline std::string extract(std::string const &meta,std::string const &key,char const *separator)
+            {
+                size_t pos=meta.find(key);
+                if(pos == std::string::npos)
+                    return "";
+                pos+=key.size(); /// size of charset=
+                size_t end_pos = meta.find_first_of(separator,pos);
+                return meta.substr(pos,end_pos - pos);
+            }
+
+            //
+            // A mo file along with its parsed header. It doesn't depend on the character type and the encoding
+            // of the facets using it, so one object is shared by all of them, see catalog_store
+            //
             class mo_file {
+                mo_file(mo_file const &);
+                void operator=(mo_file const &);
             public:
                 typedef std::pair<char const *,char const *> pair_type;
 
                 mo_file(std::vector<char> &file):
+                    index_mask_(0),
+                    index_shift_(0),
                     native_byteorder_(true),
-                    size_(0)
+                    size_(0),
+                    ascii_keys_(false)
                 {
                     load_file(file);
                     init();
                 }
 
                 mo_file(FILE *file):
+                    index_mask_(0),
+                    index_shift_(0),
                     native_byteorder_(true),
-                    size_(0)
+                    size_(0),
+                    ascii_keys_(false)
                 {
                     load_file(file);
                     init();
                 }
 
-                pair_type find(char const *context_in,char const *key_in) const
+                typedef catalog_entry<char> entry_type;
+
+                entry_type find(char const *context_in,char const *key_in,unsigned *probes = 0) const
                 {
-                    pair_type null_pair((char const *)0,(char const *)0);
-                    if(hash_size_==0)
-                        return null_pair;
+                    if(size_==0)
+                        return entry_type();
                     uint32_t hkey = 0;
                     if(context_in == 0)
                         hkey = pj_winberger_hash_function(key_in);
@@ -135,23 +473,34 @@ namespace boost {
                         st = pj_winberger_hash::update_state(st,key_in);
                         hkey = st;
                     }
+                    return find(context_in,key_in,hkey,probes);
+                }
+
+                // Find the key using an already calculated hash of it,
+                // the number of visited slots of the hash table is added to probes if given
+                entry_type find(char const *context_in,char const *key_in,uint32_t hkey,unsigned *probes = 0) const
+                {
+                    if(hash_size_==0)
+                        return find_in_index(context_in,key_in,hkey,probes);
                     uint32_t incr = 1 + hkey % (hash_size_-2);
                     hkey %= hash_size_;
                     uint32_t orig=hkey;
 
 
                     do {
-                        uint32_t idx = get(hash_offset_ + 4*hkey);
+                        if(probes)
+                            ++*probes;
+                        uint32_t idx = at(hash_table_,hkey);
                         /// Not found
                         if(idx == 0)
-                            return null_pair;
+                            return entry_type();
                         /// If equal values return translation
                         if(key_equals(key(idx-1),context_in,key_in))
-                            return value(idx-1);
+                            return entry(idx-1);
                         /// Rehash
                         hkey=(hkey + incr) % hash_size_;
                     } while(hkey!=orig);
-                    return null_pair;
+                    return entry_type();
                 }
 
                 static bool key_equals(char const *real_key,char const *cntx,char const *key)
@@ -171,24 +520,28 @@ namespace boost {
                     }
                 }
 
+                // The tables are validated when the file is loaded, so the accessors don't check the ids
+
                 char const *key(int id) const
                 {
-                    uint32_t off = get(keys_offset_ + id*8 + 4);
-                    return data_ + off;
+                    return data_ + at(keys_table_,2*id + 1);
                 }
 
                 pair_type value(int id) const
                 {
-                    uint32_t len = get(translations_offset_ + id*8);
-                    uint32_t off = get(translations_offset_ + id*8 + 4);
-                    if(off >= file_size_ || off + len >= file_size_)
-                        throw std::runtime_error("Bad mo-file format");
+                    uint32_t len = at(values_table_,2*id);
+                    uint32_t off = at(values_table_,2*id + 1);
                     return pair_type(&data_[off],&data_[off]+len);
                 }
 
-                bool has_hash() const
+                entry_type entry(int id) const
                 {
-                    return hash_size_ != 0;
+                    pair_type v = value(id);
+                    if(forms_begin_.empty())
+                        return entry_type(v.first,v.second);
+                    uint32_t first = forms_begin_[id];
+                    uint32_t count = forms_begin_[id+1] - first;
+                    return entry_type(v.first,v.second,count ? &forms_[first] : 0,count);
                 }
 
                 size_t size() const
@@ -196,6 +549,37 @@ namespace boost {
                     return size_;
                 }
 
+                size_t file_size() const
+                {
+                    return file_size_;
+                }
+
+                // The charset given in the header
+                std::string const &encoding() const
+                {
+                    return encoding_;
+                }
+
+                // Compiled plural forms expression of the header, empty if not given
+                lambda::plural_ptr const &plural_forms() const
+                {
+                    return plural_forms_;
+                }
+
+                bool ascii_keys() const
+                {
+                    return ascii_keys_;
+                }
+
+                // Memory used by the file and the tables created when loading it
+                size_t memory() const
+                {
+                    return sizeof(*this) + file_size_
+                        + (native_keys_.size() + native_values_.size() + native_hash_.size()) * sizeof(uint32_t)
+                        + (forms_begin_.size() + forms_.size()) * sizeof(uint32_t)
+                        + index_.size() * sizeof(index_slot);
+                }
+
                 bool empty()
                 {
                     return size_ == 0;
@@ -210,13 +594,188 @@ namespace boost {
                     translations_offset_=get(16);
                     hash_size_=get(20);
                     hash_offset_=get(24);
+                    validate_tables();
+                    if(!hash_table_useable())
+                        create_index();
+                    index_plural_forms();
+                    parse_header();
+                }
+
+                // The header is the translation of the first, empty key
+                void parse_header()
+                {
+                    char const *header = size_ > 0 ? value(0).first : "";
+                    encoding_ = extract(header,"charset="," \r\n;");
+                    if(encoding_.empty())
+                        throw std::runtime_error("Invalid mo-format, encoding is not specified");
+                    std::string plural = extract(header,"plural=","\r\n;");
+                    if(!plural.empty())
+                        plural_forms_ = lambda::compile(plural.c_str());
+                    ascii_keys_ = true;
+                    for(unsigned i=0;i<size_ && ascii_keys_;i++)
+                        ascii_keys_ = details::is_us_ascii_string(key(i));
+                }
+
+                //
+                // Check the tables and the bounds of all strings once, such that lookups can read them without any checks.
+                // Tables of files in the foreign byte order are converted to the native one.
+                //
+                void validate_tables()
+                {
+                    // Each entry takes 16 bytes in the tables, don't allocate anything for garbage
+                    if(size_ > file_size_ / 16)
+                        throw std::runtime_error("Bad mo-file format");
+                    // The double hashing needs at least 3 slots, ignore smaller tables
+                    if(hash_size_ < 3)
+                        hash_size_ = 0;
+                    keys_table_ = table(keys_offset_,size_ * 2,native_keys_);
+                    values_table_ = table(translations_offset_,size_ * 2,native_values_);
+                    hash_table_ = hash_size_ ? table(hash_offset_,hash_size_,native_hash_) : 0;
+                    for(unsigned i=0;i<size_;i++) {
+                        check_string(at(keys_table_,2*i),at(keys_table_,2*i + 1));
+                        check_string(at(values_table_,2*i),at(values_table_,2*i + 1));
+                    }
+                    for(unsigned i=0;i<hash_size_;i++) {
+                        if(at(hash_table_,i) > size_)
+                            throw std::runtime_error("Bad mo-file format");
+                    }
+                }
+
+                // Get a table of \a count numbers at \a offset, \a copy holds it if it needs to be converted
+                char const *table(uint32_t offset,size_t count,std::vector<uint32_t> &copy)
+                {
+                    if(offset > file_size_ || count > (file_size_ - offset) / 4)
+                        throw std::runtime_error("Bad mo-file format");
+                    if(native_byteorder_)
+                        return data_ + offset;
+                    copy.resize(count);
+                    for(size_t i=0;i<count;i++)
+                        copy[i] = get(unsigned(offset + 4*i));
+                    return reinterpret_cast<char const *>(copy.data());
+                }
+
+                // Strings must be NUL terminated as they are returned as C strings
+                void check_string(uint32_t len,uint32_t off) const
+                {
+                    if(off >= file_size_ || len >= file_size_ - off || data_[off + len] != 0)
+                        throw std::runtime_error("Bad mo-file format");
+                }
+
+                // Read the i-th number of a validated table in the native byte order, memcpy doesn't require alignment
+                static uint32_t at(char const *table,size_t i)
+                {
+                    uint32_t tmp;
+                    memcpy(&tmp,table + 4*i,4);
+                    return tmp;
+                }
+
+                //
+                // Check that every key is found in the hash table of the file within a few probes. Files without a
+                // hash table, written with a too small one or with a different hash function are searched using
+                // an index created by the library instead.
+                //
+                bool hash_table_useable() const
+                {
+                    if(hash_size_ == 0)
+                        return false;
+                    // Unsuccessful lookups visit 1/(1-load) slots on average
+                    if(uint64_t(size_) * 10 > uint64_t(hash_size_) * 9)
+                        return false;
+                    uint64_t total_probes = 0;
+                    for(unsigned i=0;i<size_;i++) {
+                        uint32_t hkey = pj_winberger_hash_function(key(i));
+                        uint32_t incr = 1 + hkey % (hash_size_-2);
+                        hkey %= hash_size_;
+                        uint32_t const orig = hkey;
+                        for(;;) {
+                            ++total_probes;
+                            uint32_t idx = at(hash_table_,hkey);
+                            if(idx == i + 1)
+                                break;
+                            if(idx == 0)
+                                return false;
+                            hkey = (hkey + incr) % hash_size_;
+                            if(hkey == orig)
+                                return false;
+                        }
+                    }
+                    return total_probes <= uint64_t(size_) * 3;
+                }
+
+                //
+                // Open addressing table with linear probing of at most half the size of a power of two,
+                // it uses the hash function of mo files so precomputed hashes of keys work as well.
+                // The hash is stored along with the id, so most mismatches don't need to compare the keys.
+                //
+                void create_index()
+                {
+                    hash_size_ = 0;
+                    if(size_ == 0)
+                        return;
+                    uint32_t slots = 2;
+                    index_shift_ = 31;
+                    while(slots < uint64_t(size_) * 2) {
+                        slots *= 2;
+                        index_shift_--;
+                    }
+                    index_.resize(slots);
+                    index_mask_ = slots - 1;
+                    // Lookups stop at the first match, so insert backwards: the last of duplicate messages wins
+                    // as in converted catalogs
+                    for(unsigned i=size_;i-- > 0;) {
+                        uint32_t hkey = pj_winberger_hash_function(key(i));
+                        uint32_t pos = index_position(hkey);
+                        while(index_[pos].id != 0)
+                            pos = (pos + 1) & index_mask_;
+                        index_[pos].hash = hkey;
+                        index_[pos].id = i + 1;
+                    }
+                }
+
+                entry_type find_in_index(char const *context_in,char const *key_in,uint32_t hkey,unsigned *probes) const
+                {
+                    if(index_.empty())
+                        return entry_type();
+                    for(uint32_t pos = index_position(hkey);;pos = (pos + 1) & index_mask_) {
+                        if(probes)
+                            ++*probes;
+                        index_slot const &slot = index_[pos];
+                        if(slot.id == 0)
+                            return entry_type();
+                        if(slot.hash == hkey && key_equals(key(slot.id-1),context_in,key_in))
+                            return entry(slot.id-1);
+                    }
+                }
+
+                // The low bits of the hash depend mostly on the end of the key only, so the
+                // position is taken from the high bits of the product with 2^32 / golden ratio
+                uint32_t index_position(uint32_t hkey) const
+                {
+                    return uint32_t(hkey * 2654435769U) >> index_shift_;
+                }
+
+                // Find all plural forms at once, so lookups do not need to scan the translation
+                void index_plural_forms()
+                {
+                    std::vector<uint32_t> begins(size_ + 1);
+                    std::vector<uint32_t> forms;
+                    for(unsigned i=0;i<size_;i++) {
+                        begins[i] = uint32_t(forms.size());
+                        pair_type v = value(i);
+                        gnu_gettext::index_plural_forms(v.first,v.second,forms);
+                    }
+                    if(forms.empty())
+                        return;
+                    begins[size_] = uint32_t(forms.size());
+                    forms_begin_.swap(begins);
+                    forms_.swap(forms);
                 }
 
                 void load_file(std::vector<char> &data)
                 {
-                    vdata_.swap(data);
-                    file_size_ = vdata_.size();
-                    data_ = &vdata_[0];
+                    content_.assign(data);
+                    file_size_ = content_.size();
+                    data_ = content_.data();
                     if(file_size_ < 4 )
                         throw std::runtime_error("invalid 'mo' file format - the file is too short");
                     uint32_t magic=0;
@@ -244,17 +803,9 @@ namespace boost {
                     else
                         throw std::runtime_error("Invalid file format");
 
-                    fseek(file,0,SEEK_END);
-                    long len=ftell(file);
-                    if(len < 0) {
-                        throw std::runtime_error("Wrong file object");
-                    }
-                    fseek(file,0,SEEK_SET);
-                    vdata_.resize(len+1,0); // +1 to make sure the vector is not empty
-                    if(fread(&vdata_.front(),1,len,file)!=unsigned(len))
-                        throw std::runtime_error("Failed to read file");
-                    data_ = &vdata_[0];
-                    file_size_ = len;
+                    content_.read(file);
+                    data_ = content_.data();
+                    file_size_ = content_.size();
                 }
 
                 uint32_t get(unsigned offset) const
@@ -283,84 +834,379 @@ namespace boost {
                 uint32_t hash_size_;
                 uint32_t hash_offset_;
 
+                // Validated tables in the native byte order, pointing into the file or to the converted copies
+                char const *keys_table_;
+                char const *values_table_;
+                char const *hash_table_;
+                std::vector<uint32_t> native_keys_;
+                std::vector<uint32_t> native_values_;
+                std::vector<uint32_t> native_hash_;
+
+                // Index created by the library, used if hash_size_ is 0
+                struct index_slot {
+                    index_slot(): hash(0), id(0) {}
+                    uint32_t hash;
+                    uint32_t id;    ///< Message id + 1, 0 for empty slots
+                };
+                std::vector<index_slot> index_;
+                uint32_t index_mask_;
+                unsigned index_shift_;
+
+                file_content content_;
                 char const *data_;
                 size_t file_size_;
-                std::vector<char> vdata_;
                 bool native_byteorder_;
                 size_t size_;
+                // Plural forms of entry i are forms_[forms_begin_[i]] ... forms_[forms_begin_[i+1]-1],
+                // both are empty if no entry has plural forms
+                std::vector<uint32_t> forms_begin_;
+                std::vector<uint32_t> forms_;
+
+                std::string encoding_;
+                lambda::plural_ptr plural_forms_;
+                bool ascii_keys_;
             };
 
-            template<typename CharType>
-            struct mo_file_use_traits {
-                static const bool in_use = false;
-                typedef CharType char_type;
-                typedef std::pair<char_type const *,char_type const *> pair_type;
-                static pair_type use(mo_file const &/*mo*/,char_type const * /*context*/,char_type const * /*key*/)
+            //
+            // Catalog created by the catalog compiler, see compiled_catalog.hpp for the format.
+            //
+            // The data isn't validated when loading, every lookup checks the offsets it uses instead,
+            // so the load time doesn't depend on the size of the catalog.
+            //
+            class compiled_file {
+                compiled_file(compiled_file const &);
+                void operator=(compiled_file const &);
+            public:
+                compiled_file(FILE *file):
+                    messages_(0),
+                    buckets_(0),
+                    seeds_offset_(0),
+                    keys_offset_(0)
                 {
-                    return pair_type((char_type const *)(0),(char_type const *)(0));
+                    content_.read(file);
+                    data_ = content_.data();
+                    size_ = content_.size();
+                    valid_ = init();
                 }
-            };
 
-            template<>
-            struct mo_file_use_traits<char> {
-                static const bool in_use = true;
-                typedef char char_type;
-                typedef std::pair<char_type const *,char_type const *> pair_type;
-                static pair_type use(mo_file const &mo,char const *context,char const *key)
+                //
+                // False if the file was created for a different byte order or format version
+                //
+                bool valid() const
                 {
-                    return mo.find(context,key);
+                    return valid_;
                 }
-            };
-
-            template<typename CharType>
-            class converter {
-            public:
-                converter(std::string /*out_enc*/,std::string in_enc): in_(in_enc) {}
 
-                std::basic_string<CharType> operator()(char const *begin,char const *end)
+                bool ascii_keys() const
                 {
-                    return conv::to_utf<CharType>(begin,end,in_,conv::stop);
+                    return (get(4 * compiled::header_flags) & compiled::flag_ascii_keys) != 0;
                 }
 
-            private:
-                std::string in_;
-            };
-
-            template<>
-            class converter<char> {
-            public:
-                converter(std::string out_enc,std::string in_enc): out_(out_enc), in_(in_enc) {}
+                // Compiled plural forms expression, empty if not given
+                lambda::plural_ptr const &plural_forms() const
+                {
+                    return plural_forms_;
+                }
 
-                std::string operator()(char const *begin,char const *end)
+                size_t payloads() const
                 {
-                    return conv::between(begin,end,out_,in_,conv::stop);
+                    return payloads_.size();
                 }
 
-            private:
-                std::string out_,in_;
-            };
+                std::string charset(size_t payload) const
+                {
+                    return data_ + payloads_[payload].charset;
+                }
 
-            template<typename CharType>
-            struct message_key {
-                typedef CharType char_type;
-                typedef std::basic_string<char_type> string_type;
+                unsigned unit_size(size_t payload) const
+                {
+                    return payloads_[payload].unit_size;
+                }
 
+                size_t file_size() const
+                {
+                    return size_;
+                }
 
-                message_key(string_type const &c = string_type()):
-                    c_context_(0),
-                    c_key_(0)
+                template<typename CharType>
+                catalog_entry<CharType> find(size_t payload_id,CharType const *context,CharType const *id) const
                 {
-                    size_t pos = c.find(char_type(4));
-                    if(pos == string_type::npos) {
-                        key_ = c;
+                    if(messages_ == 0)
+                        return catalog_entry<CharType>();
+                    uint64_t hash = compiled::hash_key(context,id);
+                    uint32_t seed = get(seeds_offset_ + 4 * compiled::bucket(hash,buckets_));
+                    uint32_t slot = compiled::slot(hash,seed,messages_);
+                    uint32_t key_offset = get(keys_offset_ + 8 * slot);
+                    uint32_t key_length = get(keys_offset_ + 8 * slot + 4);
+                    if(!in_file(key_offset,key_length + 1))
+                        throw std::runtime_error("Bad compiled catalog format");
+                    char const *key = data_ + key_offset;
+                    char const *key_end = key + key_length;
+                    if(context && *context) {
+                        if(!match(key,key_end,context) || key == key_end || *key != 4)
+                            return catalog_entry<CharType>();
+                        ++key;
                     }
-                    else {
-                        context_ = c.substr(0,pos);
-                        key_ = c.substr(pos+1);
+                    if(!match(key,key_end,id) || key != key_end)
+                        return catalog_entry<CharType>();
+
+                    payload const &p = payloads_[payload_id];
+                    size_t entry = p.entries + 4 * compiled::entry_size * size_t(slot);
+                    uint32_t value_offset = get(entry + 4 * compiled::entry_value_offset);
+                    uint32_t value_length = get(entry + 4 * compiled::entry_value_length);
+                    uint32_t forms_index = get(entry + 4 * compiled::entry_forms_index);
+                    uint32_t forms_count = get(entry + 4 * compiled::entry_forms_count);
+                    if(uint64_t(value_offset) + value_length >= p.data_size || uint64_t(forms_index) + forms_count > p.forms_size)
+                        throw std::runtime_error("Bad compiled catalog format");
+                    CharType const *value = reinterpret_cast<CharType const *>(data_ + p.data) + value_offset;
+                    uint32_t const *forms = reinterpret_cast<uint32_t const *>(data_ + p.forms) + forms_index;
+                    return catalog_entry<CharType>(value,value + value_length,forms_count ? forms : 0,forms_count);
+                }
+
+            private:
+                struct payload {
+                    uint32_t charset;
+                    unsigned unit_size;
+                    size_t entries;
+                    size_t data;
+                    size_t data_size;
+                    size_t forms;
+                    size_t forms_size;
+                };
+
+                bool init()
+                {
+                    if(size_ < 4 * compiled::header_size)
+                        throw std::runtime_error("Invalid compiled catalog format - the file is too short");
+                    if(get(4 * compiled::header_magic) != compiled::magic || get(4 * compiled::header_version) != compiled::version)
+                        return false;
+                    messages_ = get(4 * compiled::header_messages);
+                    buckets_ = get(4 * compiled::header_buckets);
+                    seeds_offset_ = get(4 * compiled::header_seeds_offset);
+                    keys_offset_ = get(4 * compiled::header_keys_offset);
+                    uint32_t plural = get(4 * compiled::header_plural_offset);
+                    uint32_t payloads = get(4 * compiled::header_payloads);
+                    uint32_t payloads_offset = get(4 * compiled::header_payloads_offset);
+                    // Only the tables are checked here, the data referenced from them is checked on use
+                    if((messages_ != 0 && buckets_ == 0)
+                       || !in_file(seeds_offset_,4 * uint64_t(buckets_))
+                       || !in_file(keys_offset_,8 * uint64_t(messages_))
+                       || !in_file(plural,1)
+                       || !in_file(payloads_offset,4 * compiled::payload_size * uint64_t(payloads)))
+                    {
+                        throw std::runtime_error("Invalid compiled catalog format");
+                    }
+                    for(uint32_t i = 0;i < payloads;i++) {
+                        size_t record = payloads_offset + 4 * compiled::payload_size * i;
+                        payload p;
+                        p.charset = get(record + 4 * compiled::payload_charset_offset);
+                        p.unit_size = get(record + 4 * compiled::payload_unit_size);
+                        p.entries = get(record + 4 * compiled::payload_entries_offset);
+                        p.data = get(record + 4 * compiled::payload_data_offset);
+                        p.data_size = get(record + 4 * compiled::payload_data_size);
+                        p.forms = get(record + 4 * compiled::payload_forms_offset);
+                        p.forms_size = get(record + 4 * compiled::payload_forms_size);
+                        if(!in_file(p.charset,1)
+                           || (p.unit_size != 1 && p.unit_size != 2 && p.unit_size != 4)
+                           || !in_file(p.entries,4 * compiled::entry_size * uint64_t(messages_))
+                           || p.data % p.unit_size != 0
+                           || !in_file(p.data,uint64_t(p.data_size) * p.unit_size)
+                           || p.forms % 4 != 0
+                           || !in_file(p.forms,4 * uint64_t(p.forms_size)))
+                        {
+                            throw std::runtime_error("Invalid compiled catalog format");
+                        }
+                        payloads_.push_back(p);
+                    }
+                    if(plural != 0) {
+                        std::string expression(data_ + plural,std::find(data_ + plural,data_ + size_,'\0'));
+                        plural_forms_ = lambda::compile(expression.c_str());
+                    }
+                    return true;
+                }
+
+                bool in_file(uint64_t offset,uint64_t length) const
+                {
+                    return offset <= size_ && length <= size_ - offset;
+                }
+
+                uint32_t get(size_t offset) const
+                {
+                    uint32_t tmp;
+                    if(offset > size_ - 4) {
+                        throw std::runtime_error("Bad compiled catalog format");
+                    }
+                    memcpy(&tmp,data_ + offset,4);
+                    return tmp;
+                }
+
+                // Match the UTF-8 text at p with s moving p past it
+                static bool match(char const *&p,char const *e,char const *s)
+                {
+                    size_t len = strlen(s);
+                    if(size_t(e - p) < len || memcmp(p,s,len) != 0)
+                        return false;
+                    p += len;
+                    return true;
+                }
+
+                template<typename CharType>
+                static bool match(char const *&p,char const *e,CharType const *s)
+                {
+                    CharType const *s_end = s + std::char_traits<CharType>::length(s);
+                    while(s != s_end) {
+                        if(p == e)
+                            return false;
+                        utf::code_point c = utf::utf_traits<char>::decode(p,e);
+                        if(c == utf::illegal || c == utf::incomplete || c != utf::utf_traits<CharType>::decode(s,s_end))
+                            return false;
+                    }
+                    return true;
+                }
+
+                file_content content_;
+                char const *data_;
+                size_t size_;
+                bool valid_;
+                uint32_t messages_;
+                uint32_t buckets_;
+                size_t seeds_offset_;
+                size_t keys_offset_;
+                std::vector<payload> payloads_;
+                lambda::plural_ptr plural_forms_;
+            };
+
+            template<typename CharType>
+            struct mo_file_use_traits {
+                static const bool in_use = false;
+                typedef CharType char_type;
+                typedef catalog_entry<char_type> entry_type;
+                static entry_type use(mo_file const &/*mo*/,char_type const * /*context*/,char_type const * /*key*/,unsigned * /*probes*/)
+                {
+                    return entry_type();
+                }
+                static entry_type use(mo_file const &/*mo*/,char_type const * /*context*/,char_type const * /*key*/,uint32_t /*hash*/,unsigned * /*probes*/)
+                {
+                    return entry_type();
+                }
+            };
+
+            template<>
+            struct mo_file_use_traits<char> {
+                static const bool in_use = true;
+                typedef char char_type;
+                typedef catalog_entry<char_type> entry_type;
+                static entry_type use(mo_file const &mo,char const *context,char const *key,unsigned *probes)
+                {
+                    return mo.find(context,key,probes);
+                }
+                static entry_type use(mo_file const &mo,char const *context,char const *key,uint32_t hash,unsigned *probes)
+                {
+                    return mo.find(context,key,hash,probes);
+                }
+            };
+
+            template<typename CharType>
+            class converter {
+            public:
+                converter(std::string /*out_enc*/,std::string in_enc): in_(in_enc) {}
+
+                std::basic_string<CharType> operator()(char const *begin,char const *end) const
+                {
+                    return conv::to_utf<CharType>(begin,end,in_,conv::stop);
+                }
+
+            private:
+                std::string in_;
+            };
+
+            template<>
+            class converter<char> {
+            public:
+                converter(std::string out_enc,std::string in_enc): out_(out_enc), in_(in_enc) {}
+
+                std::string operator()(char const *begin,char const *end) const
+                {
+                    return conv::between(begin,end,out_,in_,conv::stop);
+                }
+
+            private:
+                std::string out_,in_;
+            };
+
+            //
+            // Converts the keys used for lookup to the encoding of the catalog
+            //
+            template<typename CharType>
+            class key_converter {
+            public:
+                key_converter(std::string /*key_enc*/,std::string mo_enc,bool /*convert*/): mo_(mo_enc) {}
+
+                std::string operator()(CharType const *begin,CharType const *end) const
+                {
+                    return conv::from_utf<CharType>(begin,end,mo_,conv::stop);
+                }
+
+            private:
+                std::string mo_;
+            };
+
+            template<>
+            class key_converter<char> {
+            public:
+                key_converter(std::string key_enc,std::string mo_enc,bool convert):
+                    key_(key_enc), mo_(mo_enc), convert_(convert)
+                {}
+
+                std::string operator()(char const *begin,char const *end) const
+                {
+                    if(!convert_)
+                        return std::string(begin,end);
+                    return conv::between(begin,end,mo_,key_,conv::stop);
+                }
+
+            private:
+                std::string key_,mo_;
+                bool convert_;
+            };
+
+            template<typename CharType>
+            struct message_key {
+                typedef CharType char_type;
+                typedef std::basic_string<char_type> string_type;
+
+
+                message_key(string_type const &c = string_type()):
+                    c_context_(0),
+                    c_key_(0),
+                    hash_(0),
+                    has_hash_(false)
+                {
+                    size_t pos = c.find(char_type(4));
+                    if(pos == string_type::npos) {
+                        key_ = c;
+                    }
+                    else {
+                        context_ = c.substr(0,pos);
+                        key_ = c.substr(pos+1);
                     }
                 }
                 message_key(char_type const *c,char_type const *k):
-                    c_key_(k)
+                    c_key_(k),
+                    hash_(0),
+                    has_hash_(false)
+                {
+                    static const char_type empty = 0;
+                    if(c!=0)
+                        c_context_ = c;
+                    else
+                        c_context_ = &empty;
+                }
+                // Lookup key with a precomputed hash as calculated by hash_function
+                message_key(char_type const *c,char_type const *k,size_t hash):
+                    c_key_(k),
+                    hash_(hash),
+                    has_hash_(true)
                 {
                     static const char_type empty = 0;
                     if(c!=0)
@@ -396,6 +1242,14 @@ namespace boost {
                         return c_key_;
                     return key_.c_str();
                 }
+                bool has_hash() const
+                {
+                    return has_hash_;
+                }
+                size_t hash() const
+                {
+                    return hash_;
+                }
             private:
                 static int compare(char_type const *l,char_type const *r)
                 {
@@ -415,34 +1269,273 @@ namespace boost {
                 string_type key_;
                 char_type const *c_context_;
                 char_type const *c_key_;
+                size_t hash_;
+                bool has_hash_;
             };
 
             template<typename CharType>
             struct hash_function {
+                typedef pj_winberger_hash::state_type state_type;
+
                 size_t operator()(message_key<CharType> const &msg) const
                 {
-                    pj_winberger_hash::state_type state = pj_winberger_hash::initial_state;
+                    if(msg.has_hash())
+                        return msg.hash();
+                    state_type state = pj_winberger_hash::initial_state;
                     CharType const *p = msg.context();
                     if(*p != 0) {
-                        CharType const *e = p;
-                        while(*e)
-                            e++;
-                        state = pj_winberger_hash::update_state(state,
-                                    reinterpret_cast<char const *>(p),
-                                    reinterpret_cast<char const *>(e));
+                        state = update(state,p);
                         state = pj_winberger_hash::update_state(state,'\4');
                     }
-                    p = msg.key();
-                    CharType const *e = p;
-                    while(*e)
-                        e++;
-                    state = pj_winberger_hash::update_state(state,
-                                reinterpret_cast<char const *>(p),
-                                reinterpret_cast<char const *>(e));
+                    return update(state,msg.key());
+                }
+
+            private:
+                static state_type update(state_type state,char const *p)
+                {
+                    return pj_winberger_hash::update_state(state,p);
+                }
+
+                // Feed only the significant bytes of each code unit: the zero bytes of wide
+                // characters would shift the distinguishing bits out of the state
+                template<typename Char>
+                static state_type update(state_type state,Char const *p)
+                {
+                    for(;*p;p++) {
+                        typename std::make_unsigned<Char>::type c = *p;
+                        do {
+                            state = pj_winberger_hash::update_state(state,static_cast<char>(c & 0xFF));
+                            c >>= 8;
+                        } while(c != 0);
+                    }
                     return state;
                 }
             };
 
+            //
+            // Catalog converted to the character type and the encoding of the facet.
+            //
+            // All keys and translations are stored in a single buffer and entries refer to them by offsets.
+            // The entries are found using an open addressing hash table, so a catalog takes a few allocations
+            // regardless of the number of the messages.
+            //
+            template<typename CharType>
+            class converted_catalog {
+                converted_catalog(converted_catalog const &);
+                void operator=(converted_catalog const &);
+            public:
+                typedef CharType char_type;
+                typedef std::basic_string<char_type> string_type;
+                typedef message_key<char_type> key_type;
+                typedef catalog_entry<char_type> entry_type;
+
+                converted_catalog(size_t messages,size_t chars):
+                    shift_(28)
+                {
+                    // Keep the load factor below 1/2, the number of messages is known in advance
+                    while(shift_ > 1 && (size_t(1) << (32 - shift_)) < messages * 2)
+                        shift_--;
+                    table_.resize(size_t(1) << (32 - shift_));
+                    entries_.reserve(messages);
+                    strings_.reserve(chars);
+                }
+
+                //
+                // Add a message, the \a key is the id prefixed by the context and EOT if the context is not empty
+                //
+                void add(string_type const &key,string_type const &value)
+                {
+                    entry new_entry = entry();
+                    new_entry.key = offset(strings_.size());
+                    size_t pos = key.find(char_type(4));
+                    if(pos == string_type::npos) {
+                        strings_.push_back(0); // empty context
+                        strings_.insert(strings_.end(),key.begin(),key.end());
+                    }
+                    else {
+                        strings_.insert(strings_.end(),key.begin(),key.end());
+                        strings_[new_entry.key + pos] = 0;
+                    }
+                    strings_.push_back(0);
+                    new_entry.value = offset(strings_.size());
+                    new_entry.value_size = offset(value.size());
+                    strings_.insert(strings_.end(),value.begin(),value.end());
+                    strings_.push_back(0);
+
+                    std::vector<uint32_t> forms;
+                    index_plural_forms(value.data(),value.data() + value.size(),forms);
+                    new_entry.forms = offset(forms_.size());
+                    new_entry.forms_count = offset(forms.size());
+                    forms_.insert(forms_.end(),forms.begin(),forms.end());
+
+                    char_type const *context = &strings_[new_entry.key];
+                    key_type lookup(context,context + std::char_traits<char_type>::length(context) + 1);
+                    new_entry.hash = uint32_t(hash_function<char_type>()(lookup));
+
+                    slot *s = find_slot(lookup,new_entry.hash);
+                    if(s->entry == 0) {
+                        entries_.push_back(new_entry);
+                        s->hash = new_entry.hash;
+                        s->entry = offset(entries_.size());
+                    }
+                    else {
+                        // Duplicate message, the last one wins
+                        entries_[s->entry - 1] = new_entry;
+                    }
+                }
+
+                //
+                // Release the memory reserved in advance
+                //
+                void shrink()
+                {
+                    std::vector<char_type>(strings_).swap(strings_);
+                    std::vector<entry>(entries_).swap(entries_);
+                    std::vector<uint32_t>(forms_).swap(forms_);
+                }
+
+                entry_type find(key_type const &key) const
+                {
+                    uint32_t hash = uint32_t(hash_function<char_type>()(key));
+                    slot const *s = find_slot(key,hash);
+                    if(s->entry == 0)
+                        return entry_type();
+                    entry const &e = entries_[s->entry - 1];
+                    char_type const *value = &strings_[e.value];
+                    return entry_type(value,value + e.value_size,
+                                      e.forms_count ? &forms_[e.forms] : 0,e.forms_count);
+                }
+
+                size_t memory() const
+                {
+                    return sizeof(*this)
+                        + strings_.capacity() * sizeof(char_type)
+                        + entries_.capacity() * sizeof(entry)
+                        + forms_.capacity() * sizeof(uint32_t)
+                        + table_.capacity() * sizeof(slot);
+                }
+
+            private:
+                struct entry {
+                    uint32_t hash;
+                    uint32_t key;           // Context followed by the id, both 0 terminated
+                    uint32_t value;
+                    uint32_t value_size;
+                    uint32_t forms;         // First plural form offset in forms_
+                    uint32_t forms_count;
+                };
+
+                struct slot {
+                    slot(): hash(0), entry(0) {}
+                    uint32_t hash;
+                    uint32_t entry;         // Index of the entry + 1, 0 for an empty slot
+                };
+
+                static uint32_t offset(size_t value)
+                {
+                    if(value > 0xFFFFFFFFu)
+                        throw std::runtime_error("Message catalog is too big");
+                    return uint32_t(value);
+                }
+
+                slot const *find_slot(key_type const &key,uint32_t hash) const
+                {
+                    size_t const mask = table_.size() - 1;
+                    // Fibonacci hashing: spread the bits of the hash such that similar keys don't form clusters
+                    size_t pos = uint32_t(hash * 2654435769u) >> shift_;
+                    for(;;) {
+                        slot const &s = table_[pos];
+                        if(s.entry == 0)
+                            return &s;
+                        if(s.hash == hash && key_equals(entries_[s.entry - 1],key))
+                            return &s;
+                        pos = (pos + 1) & mask;
+                    }
+                }
+
+                slot *find_slot(key_type const &key,uint32_t hash)
+                {
+                    return const_cast<slot *>(static_cast<converted_catalog const *>(this)->find_slot(key,hash));
+                }
+
+                bool key_equals(entry const &e,key_type const &key) const
+                {
+                    char_type const *stored = &strings_[e.key];
+                    char_type const *p = key.context();
+                    while(*stored == *p && *p != 0) {
+                        stored++;
+                        p++;
+                    }
+                    if(*stored != *p)
+                        return false;
+                    stored++;
+                    p = key.key();
+                    while(*stored == *p && *p != 0) {
+                        stored++;
+                        p++;
+                    }
+                    return *stored == *p;
+                }
+
+                std::vector<char_type> strings_;
+                std::vector<entry> entries_;
+                std::vector<uint32_t> forms_;
+                std::vector<slot> table_;
+                unsigned shift_;
+            };
+
+
+            //
+            // Untranslated keys converted to the encoding of the locale at runtime. Untranslated messages are
+            // usually shown over and over, so each of them is converted once instead of on every use.
+            //
+            // Cached values are returned by pointer, valid as long as the cache exists, so lookups don't copy
+            // them. Therefore nothing is ever removed: once max_size keys are cached new keys are converted
+            // on every use.
+            //
+            class converted_keys {
+                converted_keys(converted_keys const &);
+                void operator=(converted_keys const &);
+            public:
+                static const size_t max_size = 4096;
+
+                converted_keys() {}
+
+                // Get the converted \a key or 0 if it isn't cached
+                std::string const *get(char const *key) const
+                {
+                    uint32_t const hash = pj_winberger_hash_function(key);
+                    boost::unique_lock<boost::mutex> guard(lock_);
+                    std::pair<keys_type::const_iterator,keys_type::const_iterator> range = keys_.equal_range(hash);
+                    for(keys_type::const_iterator p = range.first;p != range.second;++p) {
+                        if(p->second.first == key)
+                            return &p->second.second;
+                    }
+                    return 0;
+                }
+
+                void add(char const *key,std::string const &value)
+                {
+                    uint32_t const hash = pj_winberger_hash_function(key);
+                    boost::unique_lock<boost::mutex> guard(lock_);
+                    if(keys_.size() >= max_size)
+                        return;
+                    // Another thread may have added it meanwhile, keep the value already handed out
+                    std::pair<keys_type::const_iterator,keys_type::const_iterator> range = keys_.equal_range(hash);
+                    for(keys_type::const_iterator p = range.first;p != range.second;++p) {
+                        if(p->second.first == key)
+                            return;
+                    }
+                    keys_.insert(std::make_pair(hash,std::make_pair(std::string(key),value)));
+                }
+
+            private:
+                // Keyed by the hash, so lookups don't need to create a string
+                typedef std::unordered_multimap<uint32_t,std::pair<std::string,std::string> > keys_type;
+
+                mutable boost::mutex lock_;
+                keys_type keys_;
+            };
 
             // By default for wide types the conversion is not requiredyy
             template<typename CharType>
@@ -450,7 +1543,9 @@ namespace boost {
                                                 std::basic_string<CharType> &/*buffer*/,
                                                 bool /*do_conversion*/,
                                                 std::string const &/*locale_encoding*/,
-                                                std::string const &/*key_encoding*/)
+                                                std::string const &/*key_encoding*/,
+                                                converted_keys &/*cache*/,
+                                                bool &/*cached*/)
             {
                 return msg;
             }
@@ -461,67 +1556,637 @@ namespace boost {
                                             std::string &buffer,
                                             bool do_conversion,
                                             std::string const &locale_encoding,
-                                            std::string const &key_encoding)
+                                            std::string const &key_encoding,
+                                            converted_keys &cache,
+                                            bool &cached)
             {
                 if(!do_conversion)
                     return msg;
                 if(details::is_us_ascii_string(msg))
                     return msg;
-                std::string tmp = conv::between(msg,locale_encoding,key_encoding,conv::skip);
-                buffer.swap(tmp);
+                if(std::string const *converted = cache.get(msg)) {
+                    cached = true;
+                    return converted->c_str();
+                }
+                buffer = conv::between(msg,locale_encoding,key_encoding,conv::skip);
+                cache.add(msg,buffer);
                 return buffer.c_str();
             }
 
+            //
+            // Process wide store of loaded catalogs. Facets created for the same file share
+            // the loaded data as long as any of them exists, so each file is read and
+            // converted once instead of once per generated locale and character type.
+            //
+            class catalog_store {
+                catalog_store(catalog_store const &);
+                void operator=(catalog_store const &);
+            public:
+                catalog_store(): hits_(0), misses_(0) {}
+
+                static catalog_store &instance()
+                {
+                    static catalog_store store;
+                    return store;
+                }
+
+                //
+                // Return a catalog stored under \a key or create it using \a loader.
+                //
+                // The loader returns an empty pointer if the catalog does not exist
+                // and \a mem_size is used to get the memory used by the created catalog
+                //
+                template<typename Catalog,typename Loader,typename MemSize>
+                std::shared_ptr<Catalog const> get(std::string const &key,Loader loader,MemSize mem_size)
+                {
+                    {
+                        boost::unique_lock<boost::mutex> guard(lock_);
+                        entries_type::iterator p = entries_.find(key);
+                        if(p!=entries_.end()) {
+                            std::shared_ptr<void const> existing = p->second.catalog.lock();
+                            if(existing) {
+                                hits_++;
+                                return std::static_pointer_cast<Catalog const>(existing);
+                            }
+                        }
+                        misses_++;
+                    }
+                    // Don't hold the lock while loading, so other catalogs can be loaded in parallel
+                    std::shared_ptr<Catalog const> result = loader();
+                    if(!result)
+                        return result;
+                    entry new_entry;
+                    new_entry.catalog = result;
+                    new_entry.memory = mem_size(*result);
+
+                    boost::unique_lock<boost::mutex> guard(lock_);
+                    remove_expired();
+                    entry &stored = entries_[key];
+                    std::shared_ptr<void const> existing = stored.catalog.lock();
+                    // Somebody loaded the same catalog meanwhile, use it such that only one copy exists
+                    if(existing)
+                        return std::static_pointer_cast<Catalog const>(existing);
+                    stored = new_entry;
+                    return result;
+                }
+
+                catalog_store_stats stats()
+                {
+                    boost::unique_lock<boost::mutex> guard(lock_);
+                    remove_expired();
+                    catalog_store_stats result = catalog_store_stats();
+                    result.catalogs = entries_.size();
+                    for(entries_type::const_iterator p=entries_.begin();p!=entries_.end();++p)
+                        result.memory += p->second.memory;
+                    result.hits = hits_;
+                    result.misses = misses_;
+                    return result;
+                }
+
+            private:
+                struct entry {
+                    std::weak_ptr<void const> catalog;
+                    size_t memory;
+                };
+                typedef std::map<std::string,entry> entries_type;
+
+                void remove_expired()
+                {
+                    for(entries_type::iterator p=entries_.begin();p!=entries_.end();) {
+                        if(p->second.catalog.expired())
+                            entries_.erase(p++);
+                        else
+                            ++p;
+                    }
+                }
+
+                boost::mutex lock_;
+                entries_type entries_;
+                unsigned long long hits_;
+                unsigned long long misses_;
+            };
+
+            catalog_store_stats get_catalog_store_stats()
+            {
+                return catalog_store::instance().stats();
+            }
+
+            //
+            // Counters of a single domain, updated with relaxed atomic operations as only the totals are of interest
+            //
+            struct message_statistics::domain_counters {
+                // Number of different missing messages kept and of the attempts to add one,
+                // so a frequently missing message does not take the lock forever
+                static const unsigned max_missing = 64;
+                static const unsigned max_missing_attempts = max_missing * 16;
+
+                explicit domain_counters(std::string const &n): name(n)
+                {
+                    reset();
+                }
+
+                void reset()
+                {
+                    lookups.store(0,std::memory_order_relaxed);
+                    hits.store(0,std::memory_order_relaxed);
+                    misses.store(0,std::memory_order_relaxed);
+                    plural_evaluations.store(0,std::memory_order_relaxed);
+                    for(int i=0;i<message_domain_stats::probe_buckets;i++)
+                        probes[i].store(0,std::memory_order_relaxed);
+                    missing_attempts.store(0,std::memory_order_relaxed);
+                    boost::unique_lock<boost::mutex> guard(lock);
+                    missing.clear();
+                }
+
+                void add(std::atomic<unsigned long long> &counter)
+                {
+                    counter.fetch_add(1,std::memory_order_relaxed);
+                }
+
+                void add_probes(unsigned n)
+                {
+                    if(n == 0)
+                        return;
+                    add(probes[std::min<unsigned>(n,message_domain_stats::probe_buckets) - 1]);
+                }
+
+                bool wants_missing() const
+                {
+                    return missing_attempts.load(std::memory_order_relaxed) < max_missing_attempts;
+                }
+
+                void add_missing(std::string const &context,std::string const &id)
+                {
+                    missing_attempts.fetch_add(1,std::memory_order_relaxed);
+                    std::pair<std::string,std::string> msg(context,id);
+                    boost::unique_lock<boost::mutex> guard(lock);
+                    if(missing.size() < max_missing && std::find(missing.begin(),missing.end(),msg) == missing.end())
+                        missing.push_back(msg);
+                }
+
+                std::string const name;
+                std::atomic<unsigned long long> lookups;
+                std::atomic<unsigned long long> hits;
+                std::atomic<unsigned long long> misses;
+                std::atomic<unsigned long long> plural_evaluations;
+                std::atomic<unsigned long long> probes[message_domain_stats::probe_buckets];
+                std::atomic<unsigned> missing_attempts;
+                boost::mutex lock;
+                std::vector<std::pair<std::string,std::string> > missing;
+            };
+
+            struct message_statistics::data {
+                data(): key_conversions(0), cached_key_conversions(0) {}
+
+                std::atomic<unsigned long long> key_conversions;
+                std::atomic<unsigned long long> cached_key_conversions;
+                mutable boost::mutex lock;
+                // Counters are never removed, so the facets can keep pointers to them
+                std::vector<std::unique_ptr<domain_counters> > domains;
+            };
+
+            message_statistics::message_statistics(): d(new data())
+            {
+            }
+
+            message_statistics::~message_statistics()
+            {
+            }
+
+            message_stats message_statistics::get() const
+            {
+                message_stats result;
+                result.key_conversions = d->key_conversions.load(std::memory_order_relaxed);
+                result.cached_key_conversions = d->cached_key_conversions.load(std::memory_order_relaxed);
+                boost::unique_lock<boost::mutex> guard(d->lock);
+                for(size_t i=0;i<d->domains.size();i++) {
+                    domain_counters &c = *d->domains[i];
+                    message_domain_stats st;
+                    st.name = c.name;
+                    st.lookups = c.lookups.load(std::memory_order_relaxed);
+                    st.hits = c.hits.load(std::memory_order_relaxed);
+                    st.misses = c.misses.load(std::memory_order_relaxed);
+                    st.plural_evaluations = c.plural_evaluations.load(std::memory_order_relaxed);
+                    for(int j=0;j<message_domain_stats::probe_buckets;j++)
+                        st.probes[j] = c.probes[j].load(std::memory_order_relaxed);
+                    {
+                        boost::unique_lock<boost::mutex> missing_guard(c.lock);
+                        st.missing = c.missing;
+                    }
+                    result.domains.push_back(st);
+                }
+                return result;
+            }
+
+            void message_statistics::reset()
+            {
+                d->key_conversions.store(0,std::memory_order_relaxed);
+                d->cached_key_conversions.store(0,std::memory_order_relaxed);
+                boost::unique_lock<boost::mutex> guard(d->lock);
+                for(size_t i=0;i<d->domains.size();i++)
+                    d->domains[i]->reset();
+            }
+
+            message_statistics::domain_counters &message_statistics::domain(std::string const &name)
+            {
+                boost::unique_lock<boost::mutex> guard(d->lock);
+                for(size_t i=0;i<d->domains.size();i++) {
+                    if(d->domains[i]->name == name)
+                        return *d->domains[i];
+                }
+                d->domains.push_back(std::unique_ptr<domain_counters>(new domain_counters(name)));
+                return *d->domains.back();
+            }
+
+            void message_statistics::add_key_conversion(bool cached)
+            {
+                d->key_conversions.fetch_add(1,std::memory_order_relaxed);
+                if(cached)
+                    d->cached_key_conversions.fetch_add(1,std::memory_order_relaxed);
+            }
+
+            //
+            // Convert a message key to UTF-8 for the sample of missing messages
+            //
+            template<typename CharType>
+            std::string key_to_utf8(CharType const *str,std::string const &/*key_encoding*/)
+            {
+                if(!str)
+                    return std::string();
+                return conv::utf_to_utf<char>(str);
+            }
+
+            template<>
+            std::string key_to_utf8(char const *str,std::string const &key_encoding)
+            {
+                if(!str)
+                    return std::string();
+                if(details::is_us_ascii_string(str))
+                    return str;
+                return conv::to_utf<char>(str,key_encoding,conv::skip);
+            }
+
+            //
+            // Catalog that converts the messages on their first use.
+            //
+            // Lookup keys are converted to the encoding of the mo file and searched in it. Found messages are
+            // kept in an insert only open addressing table that is read without any lock, so the lookups of
+            // already converted messages don't serialize the threads. Its nodes are never removed as the
+            // returned pointers must stay valid, so the memory is bounded by the size of the catalog.
+            //
+            // Keys that aren't translated may be built at runtime and are unbounded in number, so only up to
+            // max_misses of them are remembered. Once that many are known the set is cleared and starts over.
+            //
+            template<typename CharType>
+            class lazy_catalog {
+                lazy_catalog(lazy_catalog const &);
+                void operator=(lazy_catalog const &);
+            public:
+                typedef CharType char_type;
+                typedef std::basic_string<char_type> string_type;
+                typedef message_key<char_type> key_type;
+                typedef catalog_entry<char_type> entry_type;
+
+                static const size_t max_misses = 4096;
+
+                lazy_catalog(   std::shared_ptr<mo_file const> const &mo,
+                                std::string const &mo_encoding,
+                                std::string const &locale_encoding,
+                                std::string const &key_encoding,
+                                bool convert_keys):
+                    mo_(mo),
+                    cvt_value_(locale_encoding,mo_encoding),
+                    cvt_key_(key_encoding,mo_encoding,convert_keys),
+                    table_(0),
+                    size_(0)
+                {
+                    grow(16);
+                }
+
+                entry_type find(key_type const &key) const
+                {
+                    uint32_t const hash = uint32_t(hash_function<char_type>()(key));
+                    if(node const *n = find_node(*table_.load(std::memory_order_acquire),key,hash))
+                        return n->entry();
+                    string_type stored_key = key.key();
+                    if(*key.context() != 0)
+                        stored_key = key.context() + (char_type(4) + stored_key);
+                    {
+                        boost::unique_lock<boost::mutex> guard(lock_);
+                        if(misses_.count(stored_key))
+                            return entry_type();
+                    }
+                    // A precomputed hash must match the key like it does for the other catalogs
+                    if(key.has_hash() && key.hash() != hash_function<char_type>()(key_type(key.context(),key.key())))
+                        return entry_type();
+                    // Convert without holding the lock, so lookups of other messages are not blocked
+                    std::unique_ptr<node> result(new node());
+                    if(!lookup(key,result->value)) {
+                        boost::unique_lock<boost::mutex> guard(lock_);
+                        if(misses_.size() >= max_misses)
+                            misses_.clear();
+                        misses_.insert(stored_key);
+                        return entry_type();
+                    }
+                    char_type const *begin = result->value.data();
+                    index_plural_forms(begin,begin + result->value.size(),result->forms);
+                    result->key = key_type(stored_key);
+                    result->hash = hash;
+
+                    boost::unique_lock<boost::mutex> guard(lock_);
+                    // If another thread has converted the same message meanwhile, its result is used
+                    table const &current = *table_.load(std::memory_order_relaxed);
+                    if(node const *n = find_node(current,result->key,hash))
+                        return n->entry();
+                    if((size_ + 1) * 2 > current.mask + 1)
+                        grow((current.mask + 1) * 2);
+                    nodes_.push_back(std::move(result));
+                    insert(*table_.load(std::memory_order_relaxed),nodes_.back().get());
+                    size_++;
+                    return nodes_.back()->entry();
+                }
+
+                size_t memory() const
+                {
+                    boost::unique_lock<boost::mutex> guard(lock_);
+                    size_t result = sizeof(*this);
+                    for(size_t i=0;i<tables_.size();i++)
+                        result += sizeof(table) + (tables_[i]->mask + 1) * sizeof(std::atomic<node const *>);
+                    for(size_t i=0;i<nodes_.size();i++) {
+                        node const &n = *nodes_[i];
+                        size_t chars = std::char_traits<char_type>::length(n.key.context())
+                                     + std::char_traits<char_type>::length(n.key.key())
+                                     + n.value.size() + 3;
+                        result += sizeof(node) + sizeof(void *) + chars * sizeof(char_type) + n.forms.size() * sizeof(uint32_t);
+                    }
+                    for(typename misses_type::const_iterator p=misses_.begin();p!=misses_.end();++p)
+                        result += 2 * sizeof(void *) + (p->size() + 1) * sizeof(char_type);
+                    return result;
+                }
+
+            private:
+                struct node {
+                    entry_type entry() const
+                    {
+                        return entry_type(value.data(),value.data() + value.size(),
+                                          forms.empty() ? 0 : &forms[0],uint32_t(forms.size()));
+                    }
+
+                    key_type key;
+                    uint32_t hash;
+                    string_type value;
+                    std::vector<uint32_t> forms;
+                };
+
+                // Power of two sized table, the slots are only ever changed from empty to a node
+                struct table {
+                    explicit table(size_t size):
+                        slots(new std::atomic<node const *>[size]),
+                        mask(size - 1),
+                        shift(32)
+                    {
+                        for(size_t i=0;i<size;i++)
+                            slots[i].store(0,std::memory_order_relaxed);
+                        for(size_t n=size;n>1;n/=2)
+                            shift--;
+                    }
+
+                    std::unique_ptr<std::atomic<node const *>[]> slots;
+                    size_t mask;
+                    unsigned shift;
+                };
+
+                typedef std::set<string_type> misses_type;
+
+                static node const *find_node(table const &t,key_type const &key,uint32_t hash)
+                {
+                    // Fibonacci hashing like converted_catalog
+                    for(size_t pos = uint32_t(hash * 2654435769u) >> t.shift;;pos = (pos + 1) & t.mask) {
+                        node const *n = t.slots[pos].load(std::memory_order_acquire);
+                        if(!n)
+                            return 0;
+                        if(n->hash == hash && n->key == key)
+                            return n;
+                    }
+                }
+
+                static void insert(table const &t,node const *n)
+                {
+                    size_t pos = uint32_t(n->hash * 2654435769u) >> t.shift;
+                    while(t.slots[pos].load(std::memory_order_relaxed))
+                        pos = (pos + 1) & t.mask;
+                    t.slots[pos].store(n,std::memory_order_release);
+                }
+
+                //
+                // Publish a bigger table holding all nodes, called with the lock held. Threads may still read
+                // the previous tables, so they are kept until the catalog is destroyed, together they take at
+                // most as much memory as the current one.
+                //
+                void grow(size_t size) const
+                {
+                    std::unique_ptr<table> bigger(new table(size));
+                    for(size_t i=0;i<nodes_.size();i++)
+                        insert(*bigger,nodes_[i].get());
+                    tables_.push_back(std::move(bigger));
+                    table_.store(tables_.back().get(),std::memory_order_release);
+                }
+
+                bool lookup(key_type const &key,string_type &value) const
+                {
+                    std::string context,id;
+                    try {
+                        context = to_mo_encoding(key.context());
+                        id = to_mo_encoding(key.key());
+                    }
+                    catch(conv::conversion_error const &) {
+                        // The key can't be represented in the encoding of the catalog
+                        return false;
+                    }
+                    mo_file::entry_type e = mo_->find(context.empty() ? 0 : context.c_str(),id.c_str());
+                    if(!e.begin)
+                        return false;
+                    try {
+                        value = cvt_value_(e.begin,e.end);
+                    }
+                    catch(conv::conversion_error const &) {
+                        // Unlike eager conversion there is no way to report a broken catalog,
+                        // treat the message as not translated
+                        return false;
+                    }
+                    return true;
+                }
+
+                std::string to_mo_encoding(char_type const *str) const
+                {
+                    return cvt_key_(str,str + std::char_traits<char_type>::length(str));
+                }
+
+                std::shared_ptr<mo_file const> mo_;
+                converter<char_type> cvt_value_;
+                key_converter<char_type> cvt_key_;
+                mutable boost::mutex lock_;
+                mutable std::atomic<table const *> table_;
+                mutable std::vector<std::unique_ptr<table> > tables_;
+                mutable std::vector<std::unique_ptr<node> > nodes_;
+                mutable size_t size_;
+                mutable misses_type misses_;
+            };
+
+            //
+            // Domains of a facet: a flat array of the names and an open addressing index of their hashes
+            // (linear probing, Fibonacci hashed like converted_catalog), so resolving a domain compares
+            // only the names with a matching hash. Domains are only added when the facet is created.
+            //
+            class domain_table {
+            public:
+                domain_table():
+                    shift_(31)
+                {
+                    slots_.resize(2);
+                }
+
+                void add(std::string const &name,int id)
+                {
+                    uint32_t hash = pj_winberger_hash_function(name.data(),name.data() + name.size());
+                    // A domain given twice refers to its last definition
+                    uint32_t &slot = find_slot(name,hash);
+                    if(slot != 0) {
+                        entries_[slot - 1].id = id;
+                        return;
+                    }
+                    entry e = { hash, name, id };
+                    entries_.push_back(e);
+                    // Keep the load factor at most 1/2
+                    if(entries_.size() * 2 > slots_.size())
+                        rehash(slots_.size() * 2);
+                    else
+                        slot = uint32_t(entries_.size());
+                }
+
+                int find(std::string const &name) const
+                {
+                    uint32_t hash = pj_winberger_hash_function(name.data(),name.data() + name.size());
+                    uint32_t slot = find_slot(name,hash);
+                    return slot != 0 ? entries_[slot - 1].id : -1;
+                }
+
+            private:
+                struct entry {
+                    uint32_t hash;
+                    std::string name;
+                    int id;
+                };
+
+                size_t position(uint32_t hash) const
+                {
+                    return uint32_t(hash * 2654435769u) >> shift_;
+                }
+
+                uint32_t const &find_slot(std::string const &name,uint32_t hash) const
+                {
+                    size_t const mask = slots_.size() - 1;
+                    for(size_t pos = position(hash);;pos = (pos + 1) & mask) {
+                        uint32_t const &slot = slots_[pos];
+                        if(slot == 0)
+                            return slot;
+                        entry const &e = entries_[slot - 1];
+                        if(e.hash == hash && e.name == name)
+                            return slot;
+                    }
+                }
+
+                uint32_t &find_slot(std::string const &name,uint32_t hash)
+                {
+                    return const_cast<uint32_t &>(static_cast<domain_table const *>(this)->find_slot(name,hash));
+                }
+
+                void rehash(size_t size)
+                {
+                    slots_.assign(size,0);
+                    shift_--;
+                    size_t const mask = size - 1;
+                    for(size_t i=0;i<entries_.size();i++) {
+                        size_t pos = position(entries_[i].hash);
+                        while(slots_[pos] != 0)
+                            pos = (pos + 1) & mask;
+                        slots_[pos] = uint32_t(i + 1);
+                    }
+                }
+
+                std::vector<entry> entries_;
+                std::vector<uint32_t> slots_;   // Index of the entry + 1, 0 for an empty slot
+                unsigned shift_;
+            };
+
             template<typename CharType>
             class mo_message : public message_format<CharType> {
 
                 typedef CharType char_type;
                 typedef std::basic_string<CharType> string_type;
                 typedef message_key<CharType> key_type;
-                typedef std::unordered_map<key_type,string_type,hash_function<CharType> > catalog_type;
-                typedef std::vector<catalog_type> catalogs_set_type;
-                typedef std::map<std::string,int> domains_map_type;
+                typedef converted_catalog<CharType> catalog_type;
+                typedef std::vector<std::shared_ptr<catalog_type const> > catalogs_set_type;
+                typedef lazy_catalog<CharType> lazy_catalog_type;
             public:
 
-                typedef std::pair<CharType const *,CharType const *> pair_type;
+                typedef catalog_entry<CharType> entry_type;
 
                 char_type const *get(int domain_id,char_type const *context,char_type const *in_id) const override
                 {
-                    return get_string(domain_id,context,in_id).first;
+                    return lookup(domain_id,context,in_id,0,false).begin;
                 }
 
                 char_type const *get(int domain_id,char_type const *context,char_type const *single_id,int n) const override
                 {
-                    pair_type ptr = get_string(domain_id,context,single_id);
-                    if(!ptr.first)
-                        return 0;
-                    int form=0;
-                    if(plural_forms_.at(domain_id))
-                        form = (*plural_forms_[domain_id])(n);
-                    else
-                        form = n == 1 ? 0 : 1; // Fallback to english plural form
+                    return get_plural(lookup(domain_id,context,single_id,0,true),domain_id,n);
+                }
 
-                    CharType const *p=ptr.first;
-                    for(int i=0;p < ptr.second && i<form;i++) {
-                        p=std::find(p,ptr.second,0);
-                        if(p==ptr.second)
-                            return 0;
-                        ++p;
-                    }
-                    if(p>=ptr.second)
+                char_type const *get_hashed(int domain_id,char_type const *context,char_type const *in_id,message_key_hash hash) const override
+                {
+                    return lookup(domain_id,context,in_id,&hash,false).begin;
+                }
+
+                char_type const *get_hashed(int domain_id,char_type const *context,char_type const *single_id,int n,message_key_hash hash) const override
+                {
+                    return get_plural(lookup(domain_id,context,single_id,&hash,true),domain_id,n);
+                }
+
+                bool get_forms(int domain_id,char_type const *context,char_type const *id,std::vector<char_type const *> &forms) const override
+                {
+                    entry_type entry = lookup(domain_id,context,id,0,false);
+                    if(!entry.begin)
+                        return false;
+                    forms.push_back(entry.begin);
+                    for(int i=1;entry.form(i);i++)
+                        forms.push_back(entry.form(i));
+                    return true;
+                }
+
+                int plural_form(int domain_id,int n) const override
+                {
+                    if(domain_id >= 0 && size_t(domain_id) < plural_forms_.size() && plural_forms_[domain_id])
+                        return (*plural_forms_[domain_id])(n);
+                    return n == 1 ? 0 : 1; // Fallback to english plural form
+                }
+
+                char_type const *get_plural(entry_type const &entry,int domain_id,int n) const
+                {
+                    if(!entry.begin)
                         return 0;
-                    return p;
+                    return entry.form(plural_form(domain_id,n));
                 }
 
                 int domain(std::string const &domain) const override
                 {
-                    domains_map_type::const_iterator p=domains_.find(domain);
-                    if(p==domains_.end())
-                        return -1;
-                    return p->second;
+                    return domains_.find(domain);
                 }
 
-                mo_message(messages_info const &inf): key_conversion_required_(false)
+                mo_message(messages_info const &inf):
+                    locale_encoding_(inf.encoding),
+                    key_conversion_required_(false),
+                    lazy_conversion_(inf.lazy_conversion),
+                    stats_(inf.statistics)
                 {
                     std::string language = inf.language;
                     std::string variant = inf.variant;
@@ -549,29 +2214,65 @@ namespace boost {
                     paths.push_back(language);
 
                     catalogs_.resize(domains.size());
+                    compiled_catalogs_.resize(domains.size());
+                    lazy_catalogs_.resize(domains.size());
                     mo_catalogs_.resize(domains.size());
                     plural_forms_.resize(domains.size());
 
 
                     for(unsigned i=0;i<domains.size();i++) {
-                        std::string domain=domains[i].name;
-                        std::string key_encoding = domains[i].encoding;
-                        domains_[domain]=i;
-
+                        domains_.add(domains[i].name,i);
+                        key_encodings_.push_back(domains[i].encoding);
+                        if(stats_)
+                            counters_.push_back(&stats_->domain(domains[i].name));
+
+                        key_encoding_ = domains[i].encoding;
+                        key_conversion_required_ =  sizeof(CharType) == 1
+                                                    && compare_encodings(encoding,key_encoding_)!=0;
+                    }
 
-                        bool found=false;
-                        for(unsigned j=0;!found && j<paths.size();j++) {
-                            for(unsigned k=0;!found && k<search_paths.size();k++) {
-                                std::string full_path = search_paths[k]+"/"+paths[j]+"/" + lc_cat + "/"+domain+".mo";
-                                found = load_file(full_path,encoding,key_encoding,i,inf.callback);
+                    // Custom file systems can't be listed
+                    bool const use_listings = !inf.callback;
+                    directory_cache directories;
+
+                    // Each domain only writes its own entries of the catalog tables, so they can be loaded concurrently
+                    auto load_domain = [&](size_t i) {
+                        std::string const &domain = domains[i].name;
+                        std::string const &key_encoding = domains[i].encoding;
+                        for(unsigned j=0;j<paths.size();j++) {
+                            for(unsigned k=0;k<search_paths.size();k++) {
+                                std::string dir = search_paths[k]+"/"+paths[j]+"/" + lc_cat;
+                                std::string base_path = dir + "/" + domain;
+                                // Prefer the compiled catalog if there is one usable for this facet
+                                if( (!use_listings || directories.may_exist(dir,domain + ".mcat"))
+                                    && load_compiled(base_path+".mcat",encoding,key_encoding,i,inf.callback))
+                                {
+                                    return;
+                                }
+                                if( (!use_listings || directories.may_exist(dir,domain + ".mo"))
+                                    && load_file(base_path+".mo",encoding,key_encoding,i,inf.callback))
+                                {
+                                    return;
+                                }
                             }
                         }
+                    };
+                    // The callback of the user isn't required to be thread safe, so it is only called by this thread
+                    if(inf.callback) {
+                        for(size_t i=0;i<domains.size();i++)
+                            load_domain(i);
                     }
+                    else
+                        parallel_for(domains.size(),load_domain);
                 }
 
                 char_type const *convert(char_type const *msg,string_type &buffer) const override
                 {
-                    return runtime_conversion<char_type>(msg,buffer,key_conversion_required_,locale_encoding_,key_encoding_);
+                    bool cached = false;
+                    char_type const *result = runtime_conversion<char_type>(msg,buffer,key_conversion_required_,locale_encoding_,key_encoding_,converted_keys_,cached);
+                    if(stats_ && result != msg)
+                        stats_->add_key_conversion(cached);
+                    return result;
                 }
 
             private:
@@ -603,13 +2304,8 @@ namespace boost {
                                 int idx,
                                 messages_info::callback_type const &callback)
                 {
-                    locale_encoding_ = locale_encoding;
-                    key_encoding_ = key_encoding;
-
-                    key_conversion_required_ =  sizeof(CharType) == 1
-                                                && compare_encodings(locale_encoding,key_encoding)!=0;
-
-                    std::shared_ptr<mo_file> mo;
+                    std::shared_ptr<mo_file const> mo;
+                    std::string file_id;
 
                     if(callback) {
                         std::vector<char> vfile = callback(file_name,locale_encoding);
@@ -618,116 +2314,270 @@ namespace boost {
                         mo.reset(new mo_file(vfile));
                     }
                     else {
-                        c_file the_file;
-                        the_file.open(file_name,locale_encoding);
-                        if(!the_file.file)
+                        if(!get_file_identity(file_name,locale_encoding,file_id))
+                            return false;
+                        mo = catalog_store::instance().get<mo_file>(
+                            "mo:" + file_id,
+                            [&]() {
+                                std::shared_ptr<mo_file> result;
+                                c_file the_file;
+                                the_file.open(file_name,locale_encoding);
+                                if(the_file.file)
+                                    result.reset(new mo_file(the_file.file));
+                                return result;
+                            },
+                            [](mo_file const &f) { return f.memory(); });
+                        if(!mo)
                             return false;
-                        mo.reset(new mo_file(the_file.file));
                     }
 
-                    std::string plural = extract(mo->value(0).first,"plural=","\r\n;");
-
-                    std::string mo_encoding = extract(mo->value(0).first,"charset="," \r\n;");
+                    std::string const &mo_encoding = mo->encoding();
+                    plural_forms_[idx] = mo->plural_forms();
 
-                    if(mo_encoding.empty())
-                        throw std::runtime_error("Invalid mo-format, encoding is not specified");
-
-                    if(!plural.empty()) {
-                        plural_forms_[idx] = lambda::compile(plural.c_str());;
-                    }
-
-                    if( mo_useable_directly(mo_encoding,*mo) )
+                    if( mo_useable_directly(mo_encoding,key_encoding,*mo) )
                     {
                         mo_catalogs_[idx]=mo;
                     }
+                    else if(lazy_conversion_) {
+                        lazy_catalogs_[idx] = load_lazy(mo,mo_encoding,key_encoding,file_id);
+                    }
+                    else if(file_id.empty()) {
+                        catalogs_[idx] = convert_catalog(*mo,mo_encoding,key_encoding);
+                    }
                     else {
-                        converter<CharType> cvt_value(locale_encoding,mo_encoding);
-                        converter<CharType> cvt_key(key_encoding,mo_encoding);
-                        for(unsigned i=0;i<mo->size();i++) {
-                            char const *ckey = mo->key(i);
-                            string_type skey = cvt_key(ckey,ckey+strlen(ckey));
-                            key_type key(skey);
-
-                            mo_file::pair_type tmp = mo->value(i);
-                            string_type value = cvt_value(tmp.first,tmp.second);
-                            catalogs_[idx][key].swap(value);
-                        }
+                        // Converted catalogs depend on the target character type and encodings
+                        std::string key = "converted:" + file_id
+                            + '\0' + typeid(CharType).name()
+                            + '\0' + convert_encoding_name(locale_encoding)
+                            + '\0' + convert_encoding_name(key_encoding);
+                        catalogs_[idx] = catalog_store::instance().get<catalog_type>(
+                            key,
+                            [&]() { return convert_catalog(*mo,mo_encoding,key_encoding); },
+                            [](catalog_type const &cat) { return cat.memory(); });
                     }
                     return true;
 
                 }
 
+                bool load_compiled( std::string const &file_name,
+                                    std::string const &locale_encoding,
+                                    std::string const &key_encoding,
+                                    int idx,
+                                    messages_info::callback_type const &callback)
+                {
+                    // Custom file systems provide mo files only
+                    if(callback)
+                        return false;
+                    std::string file_id;
+                    if(!get_file_identity(file_name,locale_encoding,file_id))
+                        return false;
+                    std::shared_ptr<compiled_file const> file = catalog_store::instance().get<compiled_file>(
+                        "compiled:" + file_id,
+                        [&]() {
+                            std::shared_ptr<compiled_file> result;
+                            c_file the_file;
+                            the_file.open(file_name,locale_encoding);
+                            if(the_file.file)
+                                result.reset(new compiled_file(the_file.file));
+                            return result;
+                        },
+                        [](compiled_file const &f) { return f.file_size(); });
+                    if(!file || !file->valid())
+                        return false;
+                    // Keys are stored in UTF-8, narrow keys in other encodings can't be looked up
+BOOST_LOCALE_START_CONST_CONDITION
+                    if(sizeof(CharType) == 1 && compare_encodings(key_encoding,"UTF-8")!=0 && !file->ascii_keys())
+                        return false;
+BOOST_LOCALE_END_CONST_CONDITION
+                    size_t payload = file->payloads();
+                    for(size_t i=0;i<file->payloads();i++) {
+                        if(file->unit_size(i) != sizeof(CharType))
+                            continue;
+BOOST_LOCALE_START_CONST_CONDITION
+                        if(sizeof(CharType) == 1 && compare_encodings(file->charset(i),locale_encoding)!=0)
+                            continue;
+BOOST_LOCALE_END_CONST_CONDITION
+                        payload = i;
+                        break;
+                    }
+                    if(payload == file->payloads())
+                        return false;
+
+                    plural_forms_[idx] = file->plural_forms();
+                    compiled_catalogs_[idx].file = file;
+                    compiled_catalogs_[idx].payload = payload;
+                    return true;
+                }
+
+                std::shared_ptr<lazy_catalog_type const> load_lazy( std::shared_ptr<mo_file const> const &mo,
+                                                                    std::string const &mo_encoding,
+                                                                    std::string const &key_encoding,
+                                                                    std::string const &file_id)
+                {
+                    bool convert_keys = sizeof(CharType) != 1 || compare_encodings(mo_encoding,key_encoding)!=0;
+                    std::string const &locale_encoding = locale_encoding_;
+                    auto loader = [&]() {
+                        return std::make_shared<lazy_catalog_type>(mo,mo_encoding,locale_encoding,key_encoding,convert_keys);
+                    };
+                    if(file_id.empty())
+                        return loader();
+                    std::string key = "lazy:" + file_id
+                        + '\0' + typeid(CharType).name()
+                        + '\0' + convert_encoding_name(locale_encoding)
+                        + '\0' + convert_encoding_name(key_encoding);
+                    return catalog_store::instance().get<lazy_catalog_type>(
+                        key,
+                        loader,
+                        [](lazy_catalog_type const &cat) { return cat.memory(); });
+                }
+
+                std::shared_ptr<catalog_type const> convert_catalog(mo_file const &mo,
+                                                                    std::string const &mo_encoding,
+                                                                    std::string const &key_encoding)
+                {
+                    // The converted text is usually about as long as the original in code units
+                    size_t chars = mo.file_size() > mo.size() * 16 ? mo.file_size() - mo.size() * 16 : 0;
+                    std::shared_ptr<catalog_type> result(new catalog_type(mo.size(),chars));
+                    converter<CharType> cvt_value(locale_encoding_,mo_encoding);
+                    converter<CharType> cvt_key(key_encoding,mo_encoding);
+                    for(unsigned i=0;i<mo.size();i++) {
+                        char const *ckey = mo.key(i);
+                        string_type key = cvt_key(ckey,ckey+strlen(ckey));
+                        mo_file::pair_type tmp = mo.value(i);
+                        result->add(key,cvt_value(tmp.first,tmp.second));
+                    }
+                    result->shrink();
+                    return result;
+                }
+
                 // Check if the mo file as-is is useful
                 // 1. It is char and not wide character
                 // 2. The locale encoding and mo encoding is same
                 // 3. The source strings encoding and mo encoding is same or all
                 //    mo key strings are US-ASCII
                 bool mo_useable_directly(   std::string const &mo_encoding,
+                                            std::string const &key_encoding,
                                             mo_file const &mo)
                 {
 BOOST_LOCALE_START_CONST_CONDITION
                     if(sizeof(CharType) != 1)
                         return false;
 BOOST_LOCALE_END_CONST_CONDITION
-                    if(!mo.has_hash())
-                        return false;
                     if(compare_encodings(mo_encoding,locale_encoding_)!=0)
                         return false;
-                    if(compare_encodings(mo_encoding,key_encoding_)==0) {
+                    if(compare_encodings(mo_encoding,key_encoding)==0) {
                         return true;
                     }
-                    for(unsigned i=0;i<mo.size();i++) {
-                        if(!details::is_us_ascii_string(mo.key(i))) {
-                            return false;
-                        }
-                    }
-                    return true;
+                    return mo.ascii_keys();
                 }
 
 
 
-                static std::string extract(std::string const &meta,std::string const &key,char const *separator)
+
+                entry_type lookup(int domain_id,char_type const *context,char_type const *id,message_key_hash const *hash,bool plural) const
                 {
-                    size_t pos=meta.find(key);
-                    if(pos == std::string::npos)
-                        return "";
-                    pos+=key.size(); /// size of charset=
-                    size_t end_pos = meta.find_first_of(separator,pos);
-                    return meta.substr(pos,end_pos - pos);
+                    if(!stats_)
+                        return hash ? get_string(domain_id,context,id,*hash,0) : get_string(domain_id,context,id,0);
+                    unsigned probes = 0;
+                    entry_type result = hash ? get_string(domain_id,context,id,*hash,&probes) : get_string(domain_id,context,id,&probes);
+                    record(domain_id,context,id,result,probes,plural);
+                    return result;
                 }
 
+                void record(int domain_id,char_type const *context,char_type const *id,entry_type const &result,unsigned probes,bool plural) const
+                {
+                    if(domain_id < 0 || size_t(domain_id) >= counters_.size())
+                        return;
+                    message_statistics::domain_counters &counters = *counters_[domain_id];
+                    counters.add(counters.lookups);
+                    counters.add_probes(probes);
+                    if(result.begin) {
+                        counters.add(counters.hits);
+                        if(plural && plural_forms_[domain_id])
+                            counters.add(counters.plural_evaluations);
+                        return;
+                    }
+                    counters.add(counters.misses);
+                    if(!counters.wants_missing())
+                        return;
+                    try {
+                        std::string const &key_encoding = key_encodings_[domain_id];
+                        counters.add_missing(key_to_utf8(context,key_encoding),key_to_utf8(id,key_encoding));
+                    }
+                    catch(std::exception const &) {
+                        // Never fail a translation because of the statistics
+                    }
+                }
 
+                entry_type get_string(int domain_id,char_type const *context,char_type const *in_id,unsigned *probes) const
+                {
+                    if(domain_id < 0 || size_t(domain_id) >= catalogs_.size())
+                        return entry_type();
+                    compiled_catalog const &compiled = compiled_catalogs_[domain_id];
+                    if(compiled.file)
+                        return compiled.file->find(compiled.payload,context,in_id);
+BOOST_LOCALE_START_CONST_CONDITION
+                    if(mo_file_use_traits<char_type>::in_use && mo_catalogs_[domain_id]) {
+BOOST_LOCALE_END_CONST_CONDITION
+                        return mo_file_use_traits<char_type>::use(*mo_catalogs_[domain_id],context,in_id,probes);
+                    }
+                    else {
+                        return find_converted(domain_id,key_type(context,in_id));
+                    }
+                }
 
-
-                pair_type get_string(int domain_id,char_type const *context,char_type const *in_id) const
+                entry_type get_string(int domain_id,char_type const *context,char_type const *in_id,message_key_hash hash,unsigned *probes) const
                 {
-                    pair_type null_pair((CharType const *)0,(CharType const *)0);
                     if(domain_id < 0 || size_t(domain_id) >= catalogs_.size())
-                        return null_pair;
+                        return entry_type();
 BOOST_LOCALE_START_CONST_CONDITION
+                    // The hash is calculated over narrow characters only and compiled catalogs use a different one
+                    if(sizeof(char_type) != 1 || compiled_catalogs_[domain_id].file)
+                        return get_string(domain_id,context,in_id,probes);
                     if(mo_file_use_traits<char_type>::in_use && mo_catalogs_[domain_id]) {
 BOOST_LOCALE_END_CONST_CONDITION
-                        return mo_file_use_traits<char_type>::use(*mo_catalogs_[domain_id],context,in_id);
+                        return mo_file_use_traits<char_type>::use(*mo_catalogs_[domain_id],context,in_id,hash.value(),probes);
+                    }
+                    // Converted catalogs don't include the EOT in the hash of an empty context
+                    else if(context && *context == 0) {
+                        return find_converted(domain_id,key_type(context,in_id));
                     }
                     else {
-                        key_type key(context,in_id);
-                        catalog_type const &cat = catalogs_[domain_id];
-                        typename catalog_type::const_iterator p = cat.find(key);
-                        if(p==cat.end()) {
-                            return null_pair;
-                        }
-                        return pair_type(p->second.data(),p->second.data()+p->second.size());
+                        return find_converted(domain_id,key_type(context,in_id,hash.value()));
                     }
                 }
 
+                entry_type find_converted(int domain_id,key_type const &key) const
+                {
+                    if(lazy_catalogs_[domain_id])
+                        return lazy_catalogs_[domain_id]->find(key);
+                    if(!catalogs_[domain_id])
+                        return entry_type();
+                    return catalogs_[domain_id]->find(key);
+                }
+
+                struct compiled_catalog {
+                    compiled_catalog(): payload(0) {}
+                    std::shared_ptr<compiled_file const> file;
+                    size_t payload;
+                };
+
                 catalogs_set_type catalogs_;
-                std::vector<std::shared_ptr<mo_file> > mo_catalogs_;
-                std::vector<std::shared_ptr<lambda::plural> > plural_forms_;
-                domains_map_type domains_;
+                std::vector<compiled_catalog> compiled_catalogs_;
+                std::vector<std::shared_ptr<lazy_catalog_type const> > lazy_catalogs_;
+                std::vector<std::shared_ptr<mo_file const> > mo_catalogs_;
+                std::vector<lambda::plural_ptr> plural_forms_;
+                domain_table domains_;
 
                 std::string locale_encoding_;
                 std::string key_encoding_;
                 bool key_conversion_required_;
+                bool lazy_conversion_;
+                mutable converted_keys converted_keys_;
+
+                std::vector<std::string> key_encodings_;
+                std::shared_ptr<message_statistics> stats_;
+                std::vector<message_statistics::domain_counters *> counters_;
             };
 
             template<>
@@ -5,8 +5,13 @@
 // https://www.boost.org/LICENSE_1_0.txt
 
 #include "boost/locale/shared/mo_lambda.hpp"
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <cstring>
 #include <cstdlib>
+#include <limits>
+#include <map>
+#include <string>
 
 #ifdef BOOST_MSVC
 #pragma warning(disable:4512) //assignment operator could not be generated
@@ -18,190 +23,71 @@ namespace gnu_gettext {
 namespace lambda {
 
 namespace { // anon
-    struct identity : public plural {
-        int operator()(int n) const override
-        {
-            return n;
-        };
-        identity *clone() const override
-        {
-            return new identity();
-        }
-    };
-
-    struct unary : public plural
-    {
-        unary(plural_ptr ptr): op1(ptr) {}
-    protected:
-        plural_ptr op1;
-    };
-
-
-    struct binary : public plural
-    {
-        binary(plural_ptr p1,plural_ptr p2): op1(p1), op2(p2) {}
-    protected:
-        plural_ptr op1,op2;
-    };
-
-    struct number : public plural
-    {
-        number(int v): val(v) {}
-        int operator()(int /*n*/) const override
-        {
-            return val;
-        }
-        number *clone() const override
-        {
-            return new number(val);
-        }
-
-    private:
-        int val;
-    };
-
-    #define UNOP(name,oper)                         \
-    struct name: public unary {                     \
-        name(plural_ptr op): unary(op) {}          \
-        int operator()(int n) const override  \
-        {                                           \
-            return oper (*op1)(n);                  \
-        }                                           \
-        name *clone() const override          \
-        {                                           \
-            plural_ptr op1_copy(op1->clone());      \
-            return new name(op1_copy);              \
-        }                                           \
-    };
-
-    #define BINOP(name,oper)                        \
-    struct name : public binary                     \
-    {                                               \
-        name(plural_ptr p1,plural_ptr p2):         \
-            binary(p1,p2)                           \
-        {}                                          \
-                                                    \
-        int operator()(int n) const override \
-        {                                           \
-            return (*op1)(n) oper (*op2)(n);        \
-        }                                           \
-        name *clone() const override          \
-        {                                           \
-            plural_ptr op1_copy(op1->clone());      \
-            plural_ptr op2_copy(op2->clone());      \
-            return new name(op1_copy,op2_copy);     \
-        }                                           \
-    };
-
-    #define BINOPD(name,oper)                       \
-    struct name : public binary {                   \
-        name(plural_ptr p1,plural_ptr p2):         \
-            binary(p1,p2)                           \
-        {}                                          \
-        int operator()(int n) const override  \
-        {                                           \
-            int v1=(*op1)(n);                       \
-            int v2=(*op2)(n);                       \
-            return v2==0 ? 0 : v1 oper v2;          \
-        }                                           \
-        name *clone() const override          \
-        {                                           \
-            plural_ptr op1_copy(op1->clone());      \
-            plural_ptr op2_copy(op2->clone());      \
-            return new name(op1_copy,op2_copy);     \
-        }                                           \
-    };
 
     enum { END = 0 , SHL = 256,  SHR, GTE,LTE, EQ, NEQ, AND, OR, NUM, VARIABLE };
 
-    UNOP(l_not,!)
-    UNOP(minus,-)
-    UNOP(bin_not,~)
-
-    BINOP(mul,*)
-    BINOPD(div,/)
-    BINOPD(mod,%)
     static int level10[]={3,'*','/','%'};
-
-    BINOP(add,+)
-    BINOP(sub,-)
     static int level9[]={2,'+','-'};
-
-    BINOP(shl,<<)
-    BINOP(shr,>>)
     static int level8[]={2,SHL,SHR};
-
-    BINOP(gt,>)
-    BINOP(lt,<)
-    BINOP(gte,>=)
-    BINOP(lte,<=)
     static int level7[]={4,'<','>',GTE,LTE};
-
-    BINOP(eq,==)
-    BINOP(neq,!=)
     static int level6[]={2,EQ,NEQ};
-
-    BINOP(bin_and,&)
     static int level5[]={1,'&'};
-
-    BINOP(bin_xor,^)
     static int level4[]={1,'^'};
-
-    BINOP(bin_or,|)
     static int level3[]={1,'|'};
-
-    BINOP(l_and,&&)
     static int level2[]={1,AND};
-
-    BINOP(l_or,||)
     static int level1[]={1,OR};
 
-    struct conditional : public plural {
-        conditional(plural_ptr p1,plural_ptr p2,plural_ptr p3):
-             op1(p1),
-             op2(p2),
-             op3(p3)
-        {}
-        int operator()(int n) const override
-        {
-            return (*op1)(n) ? (*op2)(n) : (*op3)(n);
-        }
-        conditional *clone() const override
-        {
-            plural_ptr op1_copy(op1->clone());
-            plural_ptr op2_copy(op2->clone());
-            plural_ptr op3_copy(op3->clone());
-            return new conditional(op1_copy,op2_copy,op3_copy);
-        }
-    private:
-        plural_ptr op1,op2,op3;
+    enum opcode {
+        op_number,          // push value
+        op_variable,        // push n
+        op_minus,
+        op_not,
+        op_bin_not,
+        op_mul,
+        op_div,
+        op_mod,
+        op_add,
+        op_sub,
+        op_shl,
+        op_shr,
+        op_gt,
+        op_lt,
+        op_gte,
+        op_lte,
+        op_eq,
+        op_neq,
+        op_bin_and,
+        op_bin_xor,
+        op_bin_or,
+        op_and,
+        op_or,
+        op_jump_if_zero,    // pop, jump to value if zero
+        op_jump             // jump to value
     };
 
-
-    plural_ptr bin_factory(int value,plural_ptr left,plural_ptr right)
+    int binary_opcode(int token)
     {
-
-        switch(value) {
-        case '/':  return plural_ptr(new div(left,right));
-        case '*':  return plural_ptr(new mul(left,right));
-        case '%':  return plural_ptr(new mod(left,right));
-        case '+':  return plural_ptr(new add(left,right));
-        case '-':  return plural_ptr(new sub(left,right));
-        case SHL:  return plural_ptr(new shl(left,right));
-        case SHR:  return plural_ptr(new shr(left,right));
-        case '>':  return plural_ptr(new  gt(left,right));
-        case '<':  return plural_ptr(new  lt(left,right));
-        case GTE:  return plural_ptr(new gte(left,right));
-        case LTE:  return plural_ptr(new lte(left,right));
-        case  EQ:  return plural_ptr(new  eq(left,right));
-        case NEQ:  return plural_ptr(new neq(left,right));
-        case '&':  return plural_ptr(new bin_and(left,right));
-        case '^':  return plural_ptr(new bin_xor(left,right));
-        case '|':  return plural_ptr(new bin_or (left,right));
-        case AND:  return plural_ptr(new l_and(left,right));
-        case  OR:  return plural_ptr(new l_or(left,right));
+        switch(token) {
+        case '/':  return op_div;
+        case '*':  return op_mul;
+        case '%':  return op_mod;
+        case '+':  return op_add;
+        case '-':  return op_sub;
+        case SHL:  return op_shl;
+        case SHR:  return op_shr;
+        case '>':  return op_gt;
+        case '<':  return op_lt;
+        case GTE:  return op_gte;
+        case LTE:  return op_lte;
+        case  EQ:  return op_eq;
+        case NEQ:  return op_neq;
+        case '&':  return op_bin_and;
+        case '^':  return op_bin_xor;
+        case '|':  return op_bin_or;
+        case AND:  return op_and;
+        case  OR:  return op_or;
         default:
-            return plural_ptr();
+            return -1;
         }
     }
 
@@ -268,76 +154,110 @@ namespace { // anon
 
 
     #define BINARY_EXPR(expr,hexpr,list)                            \
-        plural_ptr expr()                                           \
+        bool expr()                                                 \
         {                                                           \
-            plural_ptr op1,op2;                                     \
-            if((op1=hexpr()).get()==0)                              \
-                return plural_ptr();                                \
+            if(!hexpr())                                            \
+                return false;                                       \
             while(is_in(t.next(),list)) {                           \
                 int o=t.get();                                      \
-                if((op2=hexpr()).get()==0)                          \
-                    return plural_ptr();                            \
-                op1=bin_factory(o,op1,op2);                         \
+                if(!hexpr())                                        \
+                    return false;                                   \
+                if(!emit(binary_opcode(o)))                         \
+                    return false;                                   \
             }                                                       \
-            return op1;                                             \
+            return true;                                            \
         }
 
+    //
+    // Recursive descent parser emitting the code in reverse polish notation
+    // and keeping track of the required stack size
+    //
     class parser {
     public:
 
-        parser(tokenizer &tin): t(tin) {};
+        parser(tokenizer &tin,std::vector<plural::instruction> &code):
+            t(tin),
+            code_(code),
+            depth_(0),
+            max_depth_(0)
+        {}
 
-        plural_ptr compile()
+        bool compile()
         {
-            plural_ptr res=cond_expr();
-            if(res.get() && t.next()!=END) {
-                return plural_ptr();
-            };
-            return res;
+            if(!cond_expr())
+                return false;
+            return t.next()==END;
+        }
+
+        size_t max_depth() const
+        {
+            return max_depth_;
         }
 
     private:
 
-        plural_ptr value_expr()
+        bool emit(int op,int value = 0)
+        {
+            switch(op) {
+            case op_number:
+            case op_variable:
+                depth_++;
+                break;
+            case op_minus:
+            case op_not:
+            case op_bin_not:
+            case op_jump:
+                break;
+            case -1:
+                return false;
+            default: // binary operators and op_jump_if_zero
+                depth_--;
+            }
+            if(depth_ > max_depth_)
+                max_depth_ = depth_;
+            plural::instruction ins = { op, value };
+            code_.push_back(ins);
+            return true;
+        }
+
+        bool value_expr()
         {
-            plural_ptr op;
             if(t.next()=='(') {
                 t.get();
-                if((op=cond_expr()).get()==0)
-                    return plural_ptr();
+                if(!cond_expr())
+                    return false;
                 if(t.get()!=')')
-                    return plural_ptr();
-                return op;
+                    return false;
+                return true;
             }
             else if(t.next()==NUM) {
                 int value;
                 t.get(&value);
-                return plural_ptr(new number(value));
+                return emit(op_number,value);
             }
             else if(t.next()==VARIABLE) {
                 t.get();
-                return plural_ptr(new identity());
+                return emit(op_variable);
             }
-            return plural_ptr();
+            return false;
         };
 
-        plural_ptr un_expr()
+        bool un_expr()
         {
-            plural_ptr op1;
             static int level_unary[]={3,'-','!','~'};
             if(is_in(t.next(),level_unary)) {
                 int op=t.get();
-                if((op1=un_expr()).get()==0)
-                    return plural_ptr();
+                if(!un_expr())
+                    return false;
                 switch(op) {
                 case '-':
-                    return plural_ptr(new minus(op1));
+                    return emit(op_minus);
                 case '!':
-                    return plural_ptr(new l_not(op1));
+                    return emit(op_not);
                 case '~':
-                    return plural_ptr(new bin_not(op1));
+                    return emit(op_bin_not);
                 default:
-                    return plural_ptr();
+                    return false;
                 }
             }
             else {
@@ -356,37 +276,196 @@ namespace { // anon
         BINARY_EXPR(l2,l3,level2);
         BINARY_EXPR(l1,l2,level1);
 
-        plural_ptr cond_expr()
+        bool cond_expr()
         {
-            plural_ptr cond,case1,case2;
-            if((cond=l1()).get()==0)
-                return plural_ptr();
-            if(t.next()=='?') {
-                t.get();
-                if((case1=cond_expr()).get()==0)
-                    return plural_ptr();
-                if(t.get()!=':')
-                    return plural_ptr();
-                if((case2=cond_expr()).get()==0)
-                    return plural_ptr();
+            if(!l1())
+                return false;
+            if(t.next()!='?')
+                return true;
+            t.get();
+            // cond; jump_if_zero else; case1; jump end; else: case2; end:
+            size_t jump_to_else = code_.size();
+            emit(op_jump_if_zero);
+            size_t case_depth = depth_;
+            if(!cond_expr())
+                return false;
+            size_t jump_to_end = code_.size();
+            emit(op_jump);
+            if(t.get()!=':')
+                return false;
+            code_[jump_to_else].value = int(code_.size());
+            // Only one of the cases is evaluated
+            depth_ = case_depth;
+            if(!cond_expr())
+                return false;
+            code_[jump_to_end].value = int(code_.size());
+            return true;
+        }
+
+        tokenizer &t;
+        std::vector<plural::instruction> &code_;
+        size_t depth_;
+        size_t max_depth_;
+    };
+
+} // namespace anon
+
+plural::plural(std::vector<instruction> const &code,size_t stack_size):
+    code_(code),
+    stack_size_(stack_size)
+{
+    std::vector<unsigned char> table(table_limit + 1);
+    for(int n=0;n<=table_limit;n++) {
+        int form = evaluate(n);
+        // Plural forms are small numbers, don't use the table for unusual expressions
+        if(form < 0 || form > std::numeric_limits<unsigned char>::max())
+            return;
+        table[n] = static_cast<unsigned char>(form);
+    }
+    table_.swap(table);
+}
+
+int plural::evaluate(int n) const
+{
+    static const size_t small_stack_size = 32;
+    int small_stack[small_stack_size];
+    std::vector<int> large_stack;
+    int *sp = small_stack;
+    if(stack_size_ > small_stack_size) {
+        large_stack.resize(stack_size_);
+        sp = &large_stack[0];
+    }
+
+    instruction const *code = &code_[0];
+    size_t const code_size = code_.size();
+    size_t pc = 0;
+    // sp points past the top of the stack
+    while(pc < code_size) {
+        instruction const &ins = code[pc++];
+        switch(ins.opcode) {
+        case op_number:     *sp++ = ins.value; break;
+        case op_variable:   *sp++ = n; break;
+        case op_minus:      sp[-1] = -sp[-1]; break;
+        case op_not:        sp[-1] = !sp[-1]; break;
+        case op_bin_not:    sp[-1] = ~sp[-1]; break;
+        case op_mul:        sp--; sp[-1] = sp[-1] * sp[0]; break;
+        case op_div:        sp--; sp[-1] = sp[0] == 0 ? 0 : sp[-1] / sp[0]; break;
+        case op_mod:        sp--; sp[-1] = sp[0] == 0 ? 0 : sp[-1] % sp[0]; break;
+        case op_add:        sp--; sp[-1] = sp[-1] + sp[0]; break;
+        case op_sub:        sp--; sp[-1] = sp[-1] - sp[0]; break;
+        case op_shl:        sp--; sp[-1] = sp[-1] << sp[0]; break;
+        case op_shr:        sp--; sp[-1] = sp[-1] >> sp[0]; break;
+        case op_gt:         sp--; sp[-1] = sp[-1] > sp[0]; break;
+        case op_lt:         sp--; sp[-1] = sp[-1] < sp[0]; break;
+        case op_gte:        sp--; sp[-1] = sp[-1] >= sp[0]; break;
+        case op_lte:        sp--; sp[-1] = sp[-1] <= sp[0]; break;
+        case op_eq:         sp--; sp[-1] = sp[-1] == sp[0]; break;
+        case op_neq:        sp--; sp[-1] = sp[-1] != sp[0]; break;
+        case op_bin_and:    sp--; sp[-1] = sp[-1] & sp[0]; break;
+        case op_bin_xor:    sp--; sp[-1] = sp[-1] ^ sp[0]; break;
+        case op_bin_or:     sp--; sp[-1] = sp[-1] | sp[0]; break;
+        case op_and:        sp--; sp[-1] = sp[-1] && sp[0]; break;
+        case op_or:         sp--; sp[-1] = sp[-1] || sp[0]; break;
+        case op_jump_if_zero:
+            if(*--sp == 0)
+                pc = ins.value;
+            break;
+        case op_jump:
+            pc = ins.value;
+            break;
+        }
+    }
+    return sp[-1];
+}
+
+namespace { // anon
+
+    plural_ptr compile_expression(char const *str)
+    {
+        tokenizer t(str);
+        std::vector<plural::instruction> code;
+        parser p(t,code);
+        if(!p.compile())
+            return plural_ptr();
+        return plural_ptr(new plural(code,p.max_depth()));
+    }
+
+    //
+    // Process wide table of the compiled expressions in use. All domains of a language usually have the
+    // same expression, so it is compiled once instead of for each catalog, character type and locale.
+    //
+    class plural_table {
+    public:
+        plural_ptr get(char const *str)
+        {
+            // Expressions differing in the amount of white space between the tokens are the same,
+            // it can't be removed entirely as it may separate tokens
+            std::string key;
+            for(char const *p = str;*p;p++) {
+                if(!is_blank(*p))
+                    key += *p;
+                else if(!key.empty() && !is_blank(p[1]) && p[1] != 0)
+                    key += ' ';
             }
-            else {
-                return cond;
+            boost::unique_lock<boost::mutex> guard(lock_);
+            entries_type::iterator p = entries_.find(key);
+            if(p != entries_.end()) {
+                plural_ptr existing = p->second.lock();
+                if(existing)
+                    return existing;
             }
-            return plural_ptr(new conditional(cond,case1,case2));
+            plural_ptr result = compile_expression(str);
+            if(!result)
+                return result;
+            remove_expired();
+            entries_[key] = result;
+            return result;
         }
 
-        tokenizer &t;
+        size_t size()
+        {
+            boost::unique_lock<boost::mutex> guard(lock_);
+            return entries_.size();
+        }
+
+    private:
+        typedef std::map<std::string,std::weak_ptr<plural const> > entries_type;
+
+        static bool is_blank(char c)
+        {
+            return c==' ' || c=='\r' || c=='\n' || c=='\t';
+        }
 
+        void remove_expired()
+        {
+            for(entries_type::iterator p=entries_.begin();p!=entries_.end();) {
+                if(p->second.expired())
+                    entries_.erase(p++);
+                else
+                    ++p;
+            }
+        }
+
+        boost::mutex lock_;
+        entries_type entries_;
     };
 
-} // namespace anon
+    plural_table &interned()
+    {
+        static plural_table table;
+        return table;
+    }
+
+} // anon
 
 plural_ptr compile(char const *str)
 {
-    tokenizer t(str);
-    parser p(t);
-    return p.compile();
+    return interned().get(str);
+}
+
+size_t interned_expressions()
+{
+    return interned().size();
 }
 
 
@@ -395,4 +474,3 @@ plural_ptr compile(char const *str)
 } // locale
 } // boost
 
-
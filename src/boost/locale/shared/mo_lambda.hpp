@@ -9,22 +9,61 @@
 
 #include <boost/locale/config.hpp>
 #include <memory>
+#include <vector>
 
 namespace boost {
     namespace locale {
         namespace gnu_gettext {
             namespace lambda {
 
-                struct plural {
+                ///
+                /// Plural forms expression compiled to the code of a simple stack machine.
+                ///
+                /// Results for the most common numbers are precomputed, so the usual lookup
+                /// is a single table access. Evaluation never allocates for sane expressions.
+                ///
+                class plural {
+                public:
+                    // Results are precomputed for n in [0, table_limit]
+                    static const int table_limit = 1000;
 
-                    virtual int operator()(int n) const = 0;
-                    virtual plural *clone() const = 0;
-                    virtual ~plural() {}
+                    struct instruction {
+                        int opcode;
+                        int value; // Number to push or target of a jump
+                    };
+
+                    plural(std::vector<instruction> const &code,size_t stack_size);
+
+                    int operator()(int n) const
+                    {
+                        if(0 <= n && n < int(table_.size()))
+                            return table_[n];
+                        return evaluate(n);
+                    }
+
+                    BOOST_LOCALE_DECL int evaluate(int n) const;
+
+                private:
+                    std::vector<instruction> code_;
+                    size_t stack_size_;
+                    std::vector<unsigned char> table_;
                 };
 
-                typedef std::shared_ptr<plural> plural_ptr;
+                typedef std::shared_ptr<plural const> plural_ptr;
+
+                ///
+                /// Compile a plural forms expression, returns an empty pointer if it is invalid.
+                ///
+                /// Expressions are interned: all users of an expression share one immutable object
+                /// as long as any of them holds it.
+                ///
+                BOOST_LOCALE_DECL plural_ptr compile(char const *c_expression);
 
-                plural_ptr compile(char const *c_expression);
+                ///
+                /// Number of the distinct expressions currently known to compile(). Entries of expressions
+                /// no longer used are removed when the next expression is compiled.
+                ///
+                BOOST_LOCALE_DECL size_t interned_expressions();
 
             } // lambda
         } // gnu_gettext
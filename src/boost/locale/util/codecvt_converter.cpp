@@ -12,8 +12,10 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstring>
+#include <memory>
 
 #include "boost/locale/encoding/conv.hpp"
+#include "boost/locale/encoding/simple_codepage.ipp"
 
 //#define DEBUG_CODECVT
 #ifdef DEBUG_CODECVT
@@ -79,39 +81,11 @@ namespace util {
     class simple_converter_impl {
     public:
 
-        static const int hash_table_size = 1024;
-
-        simple_converter_impl(std::string const &encoding)
+        simple_converter_impl(std::string const &encoding):
+            table_(conv::impl::get_single_byte_table(encoding.c_str()))
         {
-            for(unsigned i=0;i<128;i++)
-                to_unicode_tbl_[i]=i;
-            for(unsigned i=128;i<256;i++) {
-                char buf[2] = { char(i) , 0 };
-                uint32_t uchar=utf::illegal;
-                try {
-                    std::wstring const tmp = conv::to_utf<wchar_t>(buf,buf+1,encoding,conv::stop);
-                    if(tmp.size() == 1) {
-                        uchar = tmp[0];
-                    }
-                    else {
-                        uchar = utf::illegal;
-                    }
-                }
-                catch(conv::conversion_error const &/*e*/) {
-                    uchar = utf::illegal;
-                }
-                to_unicode_tbl_[i]=uchar;
-            }
-            for(int i=0;i<hash_table_size;i++)
-                from_unicode_tbl_[i]=0;
-            for(unsigned i=1;i<256;i++) {
-                if(to_unicode_tbl_[i]!=utf::illegal) {
-                    unsigned pos = to_unicode_tbl_[i] % hash_table_size;
-                    while(from_unicode_tbl_[pos]!=0)
-                        pos = (pos + 1) % hash_table_size;
-                    from_unicode_tbl_[pos] = i;
-                }
-            }
+            if(!table_)
+                throw conv::invalid_charset_error(encoding);
         }
 
         uint32_t to_unicode(char const *&begin,char const *end) const
@@ -119,28 +93,20 @@ namespace util {
             if(begin==end)
                 return utf::incomplete;
             unsigned char c = *begin++;
-            return to_unicode_tbl_[c];
+            return table_->to_unicode(c);
         }
         uint32_t from_unicode(uint32_t u,char *begin,char const *end) const
         {
             if(begin==end)
                 return utf::incomplete;
-            if(u==0) {
-                *begin = 0;
-                return 1;
-            }
-            unsigned pos = u % hash_table_size;
-            unsigned char c;
-            while((c=from_unicode_tbl_[pos])!=0 && to_unicode_tbl_[c]!=u)
-                pos = (pos + 1) % hash_table_size;
-            if(c==0)
+            int c = table_->from_unicode(u);
+            if(c < 0)
                return utf::illegal;
-            *begin = c;
+            *begin = static_cast<char>(c);
             return 1;
         }
     private:
-        uint32_t to_unicode_tbl_[256];
-        unsigned char from_unicode_tbl_[hash_table_size];
+        std::shared_ptr<conv::impl::single_byte_table const> table_;
     };
 
     class simple_converter : public base_converter {
@@ -208,53 +174,9 @@ namespace util {
 
     };
 
-    namespace {
-        char const *simple_encoding_table[] = {
-            "cp1250",
-            "cp1251",
-            "cp1252",
-            "cp1253",
-            "cp1254",
-            "cp1255",
-            "cp1256",
-            "cp1257",
-            "iso88591",
-            "iso885913",
-            "iso885915",
-            "iso88592",
-            "iso88593",
-            "iso88594",
-            "iso88595",
-            "iso88596",
-            "iso88597",
-            "iso88598",
-            "iso88599",
-            "koi8r",
-            "koi8u",
-            "usascii",
-            "windows1250",
-            "windows1251",
-            "windows1252",
-            "windows1253",
-            "windows1254",
-            "windows1255",
-            "windows1256",
-            "windows1257"
-        };
-
-        bool compare_strings(char const *l,char const *r)
-        {
-            return strcmp(l,r) < 0;
-        }
-    }
-
     bool check_is_simple_encoding(std::string const &encoding)
     {
-        std::string norm = conv::impl::normalize_encoding(encoding.c_str());
-        return std::binary_search<char const **>( simple_encoding_table,
-                        simple_encoding_table + sizeof(simple_encoding_table)/sizeof(char const *),
-                        norm.c_str(),
-                        compare_strings);
+        return conv::impl::is_simple_encoding(encoding.c_str());
     }
 
     std::unique_ptr<base_converter> create_utf8_converter()
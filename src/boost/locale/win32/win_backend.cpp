@@ -24,13 +24,16 @@ namespace impl_win {
 
     class winapi_localization_backend : public localization_backend {
     public:
-        winapi_localization_backend(): invalid_(true) {}
+        winapi_localization_backend(): invalid_(true), lazy_message_conversion_(false) {}
         winapi_localization_backend(winapi_localization_backend const &other):
             localization_backend(),
             paths_(other.paths_),
             domains_(other.domains_),
             locale_id_(other.locale_id_),
-            invalid_(true)
+            invalid_(true),
+            lazy_message_conversion_(other.lazy_message_conversion_),
+            // Each copy collects its own statistics
+            message_statistics_(other.message_statistics_ ? std::make_shared<gnu_gettext::message_statistics>() : nullptr)
         {}
         winapi_localization_backend *clone() const override
         {
@@ -46,11 +49,17 @@ namespace impl_win {
                 paths_.push_back(value);
             else if(name=="message_application")
                 domains_.push_back(value);
+            else if(name=="message_lazy_conversion")
+                lazy_message_conversion_ = value == "true";
+            else if(name=="message_statistics")
+                message_statistics_ = value == "true" ? std::make_shared<gnu_gettext::message_statistics>() : nullptr;
 
         }
         void clear_options()
         {
             invalid_ = true;
+            lazy_message_conversion_ = false;
+            message_statistics_.reset();
             locale_id_.clear();
             paths_.clear();
             domains_.clear();
@@ -109,11 +118,16 @@ namespace impl_win {
                     minf.encoding = inf.encoding();
                     std::copy(domains_.begin(),domains_.end(),std::back_inserter<gnu_gettext::messages_info::domains_type>(minf.domains));
                     minf.paths = paths_;
+                    minf.lazy_conversion = lazy_message_conversion_;
+                    minf.statistics = message_statistics_;
+                    std::locale messages_base = base;
+                    if(minf.statistics)
+                        messages_base = std::locale(base,new gnu_gettext::message_statistics_facet(minf.statistics));
                     switch(type) {
                     case char_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<char>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<char>(minf));
                     case wchar_t_facet:
-                        return std::locale(base,gnu_gettext::create_messages_facet<wchar_t>(minf));
+                        return std::locale(messages_base,gnu_gettext::create_messages_facet<wchar_t>(minf));
                     default:
                         return base;
                     }
@@ -135,6 +149,8 @@ namespace impl_win {
         std::string real_id_;
 
         bool invalid_;
+        bool lazy_message_conversion_;
+        std::shared_ptr<gnu_gettext::message_statistics> message_statistics_;
         winlocale lc_;
     };
 
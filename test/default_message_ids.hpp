@@ -0,0 +1,32 @@
+// Generated by message_ids from default.po, do not edit
+
+#ifndef DEFAULT_MESSAGES_MESSAGE_IDS_HPP_INCLUDED
+#define DEFAULT_MESSAGES_MESSAGE_IDS_HPP_INCLUDED
+
+#include <boost/locale/message_ids.hpp>
+
+namespace default_messages {
+
+    enum id {
+        msg_hello_HFC3B9CDA = 0,
+        msg_hello = 1,
+        msg_x_day = 2,
+        msg_H435E2132 = 3,
+        msg_context__hello = 4,
+        msg_context__x_day = 5,
+    };
+
+    static const boost::locale::message_id_key keys[6] = {
+        { 0, "#hello", 0 },
+        { 0, "hello", 0 },
+        { 0, "x day", "x days" },
+        { 0, "\327\221\327\223\327\231\327\247\327\224", 0 },
+        { "context", "hello", 0 },
+        { "context", "x day", "\327\221\327\224\327\247\327\251\327\250 x days" },
+    };
+
+    static const boost::locale::message_id_table table(keys,6);
+
+}
+
+#endif
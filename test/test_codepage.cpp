@@ -8,6 +8,7 @@
 #include <boost/locale/generator.hpp>
 #include <boost/locale/info.hpp>
 #include <boost/locale/localization_backend.hpp>
+#include <algorithm>
 #include <fstream>
 #include <vector>
 
@@ -317,6 +318,50 @@ void test_combinations()
     TEST( (utf_to_utf<CharOut,CharIn>(in::bad())==out::ok()) );
 }
 
+template<typename CharOut,typename CharIn>
+void test_long_combination(std::string const &utf8)
+{
+    using boost::locale::conv::utf_to_utf;
+    std::basic_string<CharIn> const in = utf_to_utf<CharIn>(utf8);
+    std::basic_string<CharOut> const out = utf_to_utf<CharOut>(utf8);
+    TEST(utf_to_utf<CharOut>(in) == out);
+    TEST(utf_to_utf<CharOut>(in,boost::locale::conv::stop) == out);
+}
+
+template<typename CharOut>
+void test_long_combinations(std::string const &utf8)
+{
+    test_long_combination<CharOut,char>(utf8);
+    test_long_combination<CharOut,wchar_t>(utf8);
+    #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+    test_long_combination<CharOut,char16_t>(utf8);
+    #endif
+    #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+    test_long_combination<CharOut,char32_t>(utf8);
+    #endif
+}
+
+void test_long_texts()
+{
+    std::cout << "  long texts" << std::endl;
+    // Mixed and worst case texts for the size of the result: ASCII, 2, 3 and 4 byte sequences
+    std::string const samples[] = { "a\xc3\xbc\xe2\x82\xac\xf0\x9d\x84\x9e", "\xe2\x82\xac", "\xf0\x9d\x84\x9e", "ab\xc3\xbc" };
+    for(size_t i = 0;i < sizeof(samples) / sizeof(samples[0]);i++) {
+        std::string utf8;
+        for(int j = 0;j < 1000;j++)
+            utf8 += samples[i];
+        TEST(boost::locale::conv::utf_to_utf<char>(boost::locale::conv::utf_to_utf<wchar_t>(utf8)) == utf8);
+        test_long_combinations<char>(utf8);
+        test_long_combinations<wchar_t>(utf8);
+        #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+        test_long_combinations<char16_t>(utf8);
+        #endif
+        #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+        test_long_combinations<char32_t>(utf8);
+        #endif
+    }
+}
+
 void test_all_combinations()
 {
     std::cout << "Testing utf_to_utf\n";
@@ -328,6 +373,7 @@ void test_all_combinations()
     test_combinations<wchar_t,char>();
     std::cout << "  wchar<-wchar" << std::endl;
     test_combinations<wchar_t,wchar_t>();
+    test_long_texts();
 }
 
 template<typename Char>
@@ -390,6 +436,180 @@ void test_simple_conversions()
     }
 }
 
+template<typename Char>
+void test_converters()
+{
+    using namespace boost::locale::conv;
+    std::string const latin1 = to<char>("grüßen");
+    std::basic_string<Char> const text = utf<Char>("grüßen");
+    std::basic_string<Char> const hebrew = utf<Char>("hello שלום");
+
+    utf_decoder<Char> decoder("ISO8859-1");
+    TEST(decoder.convert(latin1) == text);
+    TEST(decoder.convert(latin1.c_str(),latin1.c_str()+latin1.size()) == text);
+
+    utf_encoder<Char> encoder("ISO8859-1",stop);
+    TEST(encoder.convert(text) == latin1);
+    TESTF(encoder.convert(hebrew));
+    // Still usable after a failed conversion
+    TEST(encoder.convert(text) == latin1);
+    TEST(encoder.convert(text.c_str(),text.c_str()+text.size()) == latin1);
+
+    utf_encoder<Char> skipping_encoder("ISO8859-1");
+    TEST(skipping_encoder.convert(hebrew) == "hello ");
+
+    TEST_THROWS(utf_decoder<Char>("no-such-charset"),invalid_charset_error);
+    TEST_THROWS(utf_encoder<Char>("no-such-charset"),invalid_charset_error);
+
+    // The cached converters of the free functions are distinguished by the method
+    TEST(from_utf(hebrew,"ISO8859-1") == "hello ");
+    TESTF(from_utf(hebrew,"ISO8859-1",stop));
+    TEST(from_utf(hebrew,"ISO8859-1") == "hello ");
+    TEST(from_utf(text,"iso-8859-1",stop) == latin1);
+    TEST(to_utf<Char>(latin1,"iso8859-1") == text);
+
+    // Converting into a string replaces its content
+    std::basic_string<Char> decoded = utf<Char>("some previous content");
+    decoder.convert_into(latin1,decoded);
+    TEST(decoded == text);
+    std::string encoded = "some previous content";
+    encoder.convert_into(text,encoded);
+    TEST(encoded == latin1);
+    encoder.convert_into(text.c_str(),text.c_str()+text.size(),encoded);
+    TEST(encoded == latin1);
+
+    // Texts converted by the backends, growing the output as needed
+    std::string long_utf8;
+    for(int i = 0; i < 1000; i++)
+        long_utf8 += "hello שלום ";
+    std::basic_string<Char> const long_text = utf<Char>(long_utf8.c_str());
+    utf_encoder<Char> utf8_encoder("UTF-8");
+    utf_decoder<Char> utf8_decoder("UTF-8");
+    TEST(utf8_encoder.convert(long_text) == long_utf8);
+    TEST(utf8_decoder.convert(long_utf8) == long_text);
+    utf8_encoder.convert_into(long_text,encoded);
+    TEST(encoded == long_utf8);
+    utf8_encoder.convert_into(text,encoded);
+    TEST(encoded == utf<char>("grüßen"));
+    utf8_decoder.convert_into(long_utf8,decoded);
+    TEST(decoded == long_text);
+}
+
+void test_between_converter()
+{
+    using namespace boost::locale::conv;
+    std::string const latin1 = to<char>("grüßen");
+    std::string const utf8 = "grüßen";
+
+    between_converter to_latin1("ISO8859-1","UTF-8",stop);
+    TEST(to_latin1.convert(utf8) == latin1);
+    TESTF(to_latin1.convert("hello שלום"));
+    TEST(to_latin1.convert(utf8.c_str(),utf8.c_str()+utf8.size()) == latin1);
+
+    between_converter to_utf8("UTF-8","ISO8859-1");
+    TEST(to_utf8.convert(latin1) == utf8);
+    TEST(to_utf8.convert(latin1) == utf8);
+    std::string converted;
+    to_utf8.convert_into(latin1,converted);
+    TEST(converted == utf8);
+    to_latin1.convert_into(utf8.c_str(),utf8.c_str()+utf8.size(),converted);
+    TEST(converted == latin1);
+
+    std::string long_utf8;
+    for(int i = 0; i < 1000; i++)
+        long_utf8 += "hello שלום ";
+    between_converter to_utf16("UTF-16LE","UTF-8");
+    between_converter from_utf16("UTF-8","UTF-16LE");
+    to_utf16.convert_into(long_utf8,converted);
+    TEST(converted == to_utf16.convert(long_utf8));
+    TEST(converted.size() == 2 * utf<wchar_t>(long_utf8.c_str()).size());
+    std::string back;
+    from_utf16.convert_into(converted,back);
+    TEST(back == long_utf8);
+
+    TEST_THROWS(between_converter("UTF-8","no-such-charset"),invalid_charset_error);
+
+    // Differently spelled names of the same encodings
+    TEST(between(utf8,"ISO8859-1","UTF-8") == latin1);
+    TEST(between(utf8,"iso-8859-1","utf8") == latin1);
+    TEST(between(utf8,"ISO8859-1","UTF-8",stop) == latin1);
+    TESTF(between("hello שלום","ISO8859-1","UTF-8",stop));
+    TEST(between("hello שלום","ISO8859-1","UTF-8") == "hello ");
+
+    // Between single byte encodings
+    std::string const cp1251 = "\xef\xf0\xe8\xe2\xe5\xf2!";
+    std::string const koi8r = "\xd0\xd2\xc9\xd7\xc5\xd4!";
+    TEST(between(cp1251,"KOI8-R","windows-1251") == koi8r);
+    TEST(between(koi8r,"windows-1251","KOI8-R",stop) == cp1251);
+    TEST(between(latin1,"ISO8859-5","ISO8859-1") == "gren");
+    TESTF(between(latin1,"ISO8859-5","ISO8859-1",stop));
+}
+
+std::string convert_in_chunks(boost::locale::conv::incremental_converter &cvt,std::string const &text,size_t chunk_size,size_t out_size)
+{
+    std::string result;
+    std::vector<char> buf(out_size);
+    char const *begin = text.c_str();
+    char const *const end = begin + text.size();
+    while(begin != end) {
+        char const *const chunk_end = begin + std::min(chunk_size,size_t(end - begin));
+        bool done;
+        do {
+            char *out = &buf[0];
+            done = cvt.convert(begin,chunk_end,out,out + out_size);
+            result.append(&buf[0],out);
+        } while(!done);
+        TEST(begin == chunk_end);
+    }
+    bool done;
+    do {
+        char *out = &buf[0];
+        done = cvt.finish(out,out + out_size);
+        result.append(&buf[0],out);
+    } while(!done);
+    return result;
+}
+
+void test_incremental_converter()
+{
+    using namespace boost::locale::conv;
+    std::string const utf8 = "grüßen שלום € \xf0\x9d\x84\x9e!";
+    std::string const utf16 = between(utf8,"UTF-16LE","UTF-8");
+    std::string const latin1 = to<char>("grüßen   !");
+
+    size_t const chunk_sizes[] = { 1, 2, 3, 7, 1000 };
+    size_t const out_sizes[] = { 4, 5, 64 };
+    for(size_t const chunk_size : chunk_sizes) {
+        for(size_t const out_size : out_sizes) {
+            incremental_converter to_utf16("UTF-16LE","UTF-8",stop);
+            TEST(convert_in_chunks(to_utf16,utf8,chunk_size,out_size) == utf16);
+            // Reused after finishing the previous text
+            TEST(convert_in_chunks(to_utf16,utf8,chunk_size,out_size) == utf16);
+
+            incremental_converter to_utf8("UTF-8","UTF-16LE",stop);
+            TEST(convert_in_chunks(to_utf8,utf16,chunk_size,out_size) == utf8);
+
+            incremental_converter to_latin1("ISO8859-1","UTF-8");
+            TEST(convert_in_chunks(to_latin1,utf8,chunk_size,out_size) == latin1);
+            TEST(convert_in_chunks(to_latin1,"abc\xe2\x82",chunk_size,out_size) == "abc");
+            TEST(convert_in_chunks(to_latin1,"a\xe2\x82" "bc\xff",chunk_size,out_size) == "abc");
+        }
+    }
+
+    incremental_converter to_latin1("ISO8859-1","UTF-8",stop);
+    TESTF(convert_in_chunks(to_latin1,utf8,3,64));
+    incremental_converter incomplete("ISO8859-1","UTF-8",stop);
+    std::string const text = "abc\xe2\x82";
+    char const *begin = text.c_str();
+    char buf[16];
+    char *out = buf;
+    // The incomplete sequence is kept as the text may continue
+    TEST(incomplete.convert(begin,begin + text.size(),out,buf + sizeof(buf)));
+    TEST(std::string(buf,out) == "abc");
+    TESTF(incomplete.finish(out,buf + sizeof(buf)));
+
+    TEST_THROWS(incremental_converter("UTF-8","no-such-charset"),invalid_charset_error);
+}
 
 void test_main(int /*argc*/, char** /*argv*/)
 {
@@ -417,6 +637,14 @@ void test_main(int /*argc*/, char** /*argv*/)
 
     test_simple_conversions();
 
+    std::cout << "Testing reusable converters" << std::endl;
+    test_converters<char>();
+    test_converters<wchar_t>();
+    test_between_converter();
+    #if defined(BOOST_LOCALE_WITH_ICU) || defined(BOOST_LOCALE_WITH_ICONV)
+    test_incremental_converter();
+    #endif
+
 
     for(int type = 0; type < int(def.size()); type ++ ) {
         boost::locale::localization_backend_manager tmp_backend = boost::locale::localization_backend_manager::global();
@@ -9,10 +9,17 @@
 #include <boost/locale/message.hpp>
 #include <boost/locale/gnu_gettext.hpp>
 #include <boost/locale/encoding.hpp>
+#include <boost/locale/message_ids.hpp>
 #include "boostLocale/test/unit_test.hpp"
 #include "boostLocale/test/tools.hpp"
+// Generated from he/LC_MESSAGES/default.po by tools/message_ids
+#include "default_message_ids.hpp"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <thread>
 #include <vector>
 
 namespace bl = boost::locale;
@@ -306,6 +313,390 @@ void test_translate(std::string original,std::string expected,std::locale const
     #endif
 }
 
+// Hash function of GNU Gettext catalogs calculated at run time
+uint32_t pj_winberger_hash(std::string const &s)
+{
+    uint32_t hash = 0;
+    for(unsigned char c: s) {
+        hash = (hash << 4) + c;
+        uint32_t const high = hash & 0xF0000000U;
+        if(high != 0)
+            hash = (hash ^ (high >> 24)) ^ high;
+    }
+    return hash;
+}
+
+#define LONG_KEY_64 "The hash of long keys is calculated at compile time as well...\n"
+#define LONG_KEY_1024 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 \
+                      LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64 LONG_KEY_64
+
+void test_hashed_translate(std::locale const &l)
+{
+    // The hash must be calculated at compile time
+    static_assert(bl::hash_message_key("hello").value() != 0,"constexpr hash");
+    TEST(bl::hash_message_key("hello").value()==pj_winberger_hash("hello"));
+    TEST(bl::hash_message_key("context","hello").value()==pj_winberger_hash("context\4hello"));
+    // Keys longer than the usual constexpr nesting limit of 512
+    constexpr uint32_t long_hash = bl::hash_message_key(LONG_KEY_1024).value();
+    constexpr uint32_t long_context_hash = bl::hash_message_key(LONG_KEY_1024,LONG_KEY_64 "x").value();
+    TEST(long_hash==pj_winberger_hash(LONG_KEY_1024));
+    TEST(long_context_hash==pj_winberger_hash(LONG_KEY_1024 "\4" LONG_KEY_64 "x"));
+    TEST(BOOST_LOCALE_TRANSLATE(LONG_KEY_1024).str(l)==LONG_KEY_1024);
+
+    TEST(BOOST_LOCALE_TRANSLATE("hello").str(l)==to_correct_string<char>("שלום",l));
+    TEST(BOOST_LOCALE_TRANSLATE("untranslated").str(l)=="untranslated");
+    TEST(BOOST_LOCALE_TRANSLATE("hello").str(l,"simple")==to_correct_string<char>("היי",l));
+    TEST(BOOST_LOCALE_TRANSLATE_CTX("context","hello").str(l)==to_correct_string<char>("שלום בהקשר אחר",l));
+    TEST(BOOST_LOCALE_TRANSLATE_PLURAL("x day","x days",2).str(l)==to_correct_string<char>("יומיים",l));
+    TEST(BOOST_LOCALE_TRANSLATE_PLURAL("x day","x days",20).str(l,"undefined")=="x days");
+    TEST(BOOST_LOCALE_TRANSLATE_CTX_PLURAL("context","x day","x days",1).str(l)==to_correct_string<char>("בהקשר יום x",l));
+    // A wrong hash doesn't find the translation
+    TEST(bl::translate(bl::hash_message_key("x"),"hello").str(l)=="hello");
+    // The hash is ignored for wide characters
+    TEST(bl::translate(bl::hash_message_key("x"),L"hello").str(l)==to_correct_string<wchar_t>("שלום",l));
+
+    std::ostringstream ss;
+    ss.imbue(l);
+    ss << BOOST_LOCALE_TRANSLATE("hello");
+    TEST(ss.str()==to_correct_string<char>("שלום",l));
+}
+
+template<typename Char>
+void test_batch_translate(std::locale const &l)
+{
+    typedef std::basic_string<Char> string_type;
+    typedef typename bl::basic_message_batch<Char>::request request;
+    string_type const hello = to<Char>("hello");
+    string_type const untranslated = to<Char>("untranslated");
+    string_type const context = to<Char>("context");
+    string_type const day = to<Char>("x day");
+    string_type const days = to<Char>("x days");
+    string_type const empty;
+
+    request const requests[] = {
+        { 0, hello.c_str(), 0, 0 },
+        { 0, untranslated.c_str(), 0, 0 },
+        { context.c_str(), hello.c_str(), 0, 0 },
+        { 0, day.c_str(), days.c_str(), 2 },
+        { context.c_str(), day.c_str(), days.c_str(), 1 },
+        { 0, untranslated.c_str(), days.c_str(), 5 },
+        { 0, empty.c_str(), 0, 0 },
+    };
+    size_t const count = sizeof(requests)/sizeof(requests[0]);
+    Char const *results[count];
+
+    bl::basic_message_batch<Char> batch(l);
+    // The object can be reused
+    for(int i = 0; i < 2; i++) {
+        TEST(batch.translate(requests,count,results)==4);
+        TEST(results[0]==to_correct_string<Char>("שלום",l));
+        // Untranslated strings are not copied
+        TEST(results[1]==untranslated.c_str());
+        TEST(results[2]==to_correct_string<Char>("שלום בהקשר אחר",l));
+        TEST(results[3]==to_correct_string<Char>("יומיים",l));
+        TEST(results[4]==to_correct_string<Char>("בהקשר יום x",l));
+        TEST(results[5]==days.c_str());
+        TEST(results[6]==empty);
+    }
+
+    bl::basic_message_batch<Char> simple(l,"simple");
+    TEST(simple.translate(requests,1,results)==1);
+    TEST(results[0]==to_correct_string<Char>("היי",l));
+
+    bl::basic_message_batch<Char> undefined(l,"undefined");
+    TEST(undefined.translate(requests,count,results)==0);
+    TEST(results[0]==hello.c_str());
+    TEST(results[3]==days.c_str());
+
+    // No messages facet
+    bl::basic_message_batch<Char> classic(std::locale::classic());
+    TEST(classic.translate(requests,count,results)==0);
+    TEST(results[0]==hello);
+    TEST(results[4]==day);
+}
+
+template<typename Char>
+void test_view_translate(std::locale const &l)
+{
+    typedef std::basic_string<Char> string_type;
+    string_type const hello = to<Char>("hello");
+    string_type const untranslated = to<Char>("untranslated");
+    string_type const day = to<Char>("x day");
+    string_type const days = to<Char>("x days");
+    string_type buffer;
+
+    TEST(bl::translate(hello.c_str()).view(l,buffer)==to_correct_string<Char>("שלום",l));
+    TEST(bl::translate(hello.c_str()).view(l,"simple",buffer)==to_correct_string<Char>("היי",l));
+    TEST(bl::translate(day.c_str(),days.c_str(),2).view(l,buffer)==to_correct_string<Char>("יומיים",l));
+    // Nothing is copied
+    TEST(bl::translate(untranslated.c_str()).view(l,buffer)==untranslated.c_str());
+    TEST(bl::translate(day.c_str(),days.c_str(),5).view(l,"undefined",buffer)==days.c_str());
+    TEST(buffer.empty());
+
+    bl::basic_message<Char> const owned = bl::translate(untranslated);
+    Char const *ptr = owned.view(l,buffer);
+    TEST(ptr==untranslated);
+    TEST(ptr==owned.view(l,buffer));
+}
+
+template<typename Char>
+void test_domain_handle(std::locale const &l)
+{
+    typedef std::basic_string<Char> string_type;
+    string_type const hello = to<Char>("hello");
+    string_type const day = to<Char>("x day");
+    string_type const days = to<Char>("x days");
+
+    bl::basic_domain_handle<Char> const def(l);
+    bl::basic_domain_handle<Char> const simple(l,"simple");
+    bl::basic_domain_handle<Char> const undefined(l,"undefined");
+    TEST(def.facet());
+    TEST(simple.id()==std::use_facet<bl::message_format<Char> >(l).domain("simple"));
+    TEST(undefined.id()==-1);
+
+    TEST(bl::translate(hello).str(def)==to_correct_string<Char>("שלום",l));
+    TEST(bl::translate(hello).str(simple)==to_correct_string<Char>("היי",l));
+    TEST(bl::translate(hello).str(undefined)==hello);
+    TEST(bl::translate(day,days,2).str(def)==to_correct_string<Char>("יומיים",l));
+    TEST(bl::translate(day,days,2).str(undefined)==days);
+
+    string_type buffer;
+    TEST(bl::translate(hello.c_str()).view(simple,buffer)==to_correct_string<Char>("היי",l));
+    TEST(bl::translate(hello.c_str()).view(undefined,buffer)==hello.c_str());
+
+    {
+        std::basic_ostringstream<Char> ss;
+        ss.imbue(l);
+        ss << bl::as::domain(simple) << bl::translate(hello) << bl::as::domain(def) << bl::translate(hello);
+        TEST(ss.str()==to_correct_string<Char>("היי",l) + to_correct_string<Char>("שלום",l));
+    }
+
+    typename bl::basic_message_batch<Char>::request const request = { 0, hello.c_str(), 0, 0 };
+    Char const *result = 0;
+    bl::basic_message_batch<Char> batch(simple);
+    TEST(batch.translate(&request,1,&result)==1);
+    TEST(result==to_correct_string<Char>("היי",l));
+
+    // No messages facet
+    bl::basic_domain_handle<Char> const classic(std::locale::classic(),"simple");
+    TEST(!classic.facet());
+    TEST(bl::translate(hello).str(classic)==hello);
+}
+
+template<typename Char>
+void test_message_ids(std::locale const &l)
+{
+    namespace ids = default_messages;
+    typedef std::basic_string<Char> string_type;
+    string_type const context = to<Char>("context");
+    string_type const day = to<Char>("x day");
+    string_type const days = to<Char>("x days");
+    string_type const context_days = to_correct_string<Char>("בהקשר x days",l);
+
+    bl::basic_message_ids<Char> const def(l,ids::table);
+    TEST(def.size()==6);
+    TEST(def.translated()==6);
+    TEST(def.translate(ids::msg_hello)==to_correct_string<Char>("שלום",l));
+    TEST(def.translate(ids::msg_hello_HFC3B9CDA)==to_correct_string<Char>("#שלום",l));
+    TEST(def.translate(ids::msg_context__hello)==to_correct_string<Char>("שלום בהקשר אחר",l));
+    TEST(def.translate(ids::msg_H435E2132)==to<Char>("test"));
+    for(int n : {0,1,2,5,11,1001}) {
+        TEST(def.translate(ids::msg_x_day,n)==bl::translate(day,days,n).str(l));
+        TEST(def.translate(ids::msg_context__x_day,n)==bl::translate(context,day,context_days,n).str(l));
+    }
+
+    bl::basic_message_ids<Char> const simple(bl::basic_domain_handle<Char>(l,"simple"),ids::table);
+    TEST(simple.translated()==3);
+    TEST(simple.translate(ids::msg_hello)==to_correct_string<Char>("היי",l));
+    TEST(simple.translate(ids::msg_H435E2132)==to_correct_string<Char>("בדיקה",l));
+    TEST(simple.translate(ids::msg_x_day,1)==day);
+    TEST(simple.translate(ids::msg_x_day,2)==days);
+    TEST(simple.translate(ids::msg_context__x_day,2)==context_days);
+
+    bl::basic_message_ids<Char> const undefined(l,ids::table,"undefined");
+    TEST(undefined.translated()==0);
+    TEST(undefined.translate(ids::msg_hello)==to<Char>("hello"));
+
+    // No messages facet
+    bl::basic_message_ids<Char> const classic(std::locale::classic(),ids::table);
+    TEST(classic.translated()==0);
+    TEST(classic.translate(ids::msg_hello)==to<Char>("hello"));
+    TEST(classic.translate(ids::msg_x_day,3)==days);
+}
+
+std::vector<char> read_file(std::string const &name)
+{
+    return file_loader()(name,"UTF-8");
+}
+
+uint32_t get_u32(std::vector<char> const &data,size_t offset)
+{
+    uint32_t v;
+    memcpy(&v,&data[offset],4);
+    return v;
+}
+
+void set_u32(std::vector<char> &data,size_t offset,uint32_t v)
+{
+    memcpy(&data[offset],&v,4);
+}
+
+// Convert the header and all tables of a mo file in native byte order to the other one
+std::vector<char> byteswap_mo(std::vector<char> data)
+{
+    uint32_t const messages = get_u32(data,8);
+    uint32_t const keys = get_u32(data,12);
+    uint32_t const values = get_u32(data,16);
+    uint32_t const hash_size = get_u32(data,20);
+    uint32_t const hash = get_u32(data,24);
+    std::vector<size_t> offsets;
+    for(size_t i = 0; i < 7; i++)
+        offsets.push_back(4*i);
+    for(size_t i = 0; i < 2*messages; i++) {
+        offsets.push_back(keys + 4*i);
+        offsets.push_back(values + 4*i);
+    }
+    for(size_t i = 0; i < hash_size; i++)
+        offsets.push_back(hash + 4*i);
+    for(size_t offset: offsets)
+        std::reverse(data.begin() + offset,data.begin() + offset + 4);
+    return data;
+}
+
+std::locale mo_file_locale(std::vector<char> const &content,
+                           std::shared_ptr<bl::gnu_gettext::message_statistics> const &statistics = nullptr,
+                           bool lazy_conversion = false)
+{
+    bl::gnu_gettext::messages_info info;
+    info.language = "he";
+    info.encoding = "UTF-8";
+    info.paths.push_back(".");
+    info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+    info.callback = [content](std::string const &name,std::string const &) {
+        return name.find("/he/") != std::string::npos ? content : std::vector<char>();
+    };
+    info.statistics = statistics;
+    info.lazy_conversion = lazy_conversion;
+    std::locale l(std::locale::classic(),bl::gnu_gettext::create_messages_facet<char>(info));
+    #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+    l = std::locale(l,bl::gnu_gettext::create_messages_facet<char16_t>(info));
+    #endif
+    return std::locale(l,bl::gnu_gettext::create_messages_facet<wchar_t>(info));
+}
+
+typedef std::vector<std::pair<std::string,std::string> > mo_messages;
+
+// Create a mo file in the native byte order without a hash table, so the library indexes it on its own
+std::vector<char> make_mo(mo_messages const &messages)
+{
+    uint32_t const count = uint32_t(messages.size());
+    uint32_t const keys = 28;
+    uint32_t const values = keys + 8*count;
+    uint32_t offset = values + 8*count;
+    std::vector<char> data(offset);
+    uint32_t const header[] = { 0x950412de, 0, count, keys, values, 0, offset };
+    for(size_t i = 0; i < 7; i++)
+        set_u32(data,4*i,header[i]);
+    for(uint32_t i = 0; i < count; i++) {
+        std::string const *strings[] = { &messages[i].first, &messages[i].second };
+        for(uint32_t j = 0; j < 2; j++) {
+            set_u32(data,(j ? values : keys) + 8*i,uint32_t(strings[j]->size()));
+            set_u32(data,(j ? values : keys) + 8*i + 4,offset);
+            data.insert(data.end(),strings[j]->begin(),strings[j]->end());
+            data.push_back(0);
+            offset += uint32_t(strings[j]->size()) + 1;
+        }
+    }
+    return data;
+}
+
+std::string plural_key(std::string const &single,std::string const &plural)
+{
+    return single + '\0' + plural;
+}
+
+std::string context_key(std::string const &context,std::string const &id)
+{
+    return context + '\4' + id;
+}
+
+// Messages of the catalog created by generated_catalog with i < messages
+std::string generated_message(int i)
+{
+    return "message " + std::to_string(i);
+}
+
+std::string generated_translation(int i)
+{
+    return "תרגום " + std::to_string(i);
+}
+
+std::vector<char> generated_catalog(int messages)
+{
+    mo_messages m;
+    m.push_back(std::make_pair("","Content-Type: text/plain; charset=UTF-8\nPlural-Forms: nplurals=2; plural=(n != 1);\n"));
+    m.push_back(std::make_pair("hello","שלום"));
+    m.push_back(std::make_pair(context_key("context","hello"),"שלום בהקשר"));
+    // Same id in another context and a context equal to an id
+    m.push_back(std::make_pair(context_key("hello","world"),"עולם בהקשר"));
+    m.push_back(std::make_pair("world","עולם"));
+    // The same characters split differently between the context and the id
+    m.push_back(std::make_pair(context_key("a","bc"),"a bc"));
+    m.push_back(std::make_pair(context_key("ab","c"),"ab c"));
+    // Keys with the same hash
+    m.push_back(std::make_pair("ab","hash 1"));
+    m.push_back(std::make_pair("bR","hash 2"));
+    m.push_back(std::make_pair("cB","hash 3"));
+    // Duplicate messages, the last one is used
+    m.push_back(std::make_pair("duplicate","first"));
+    m.push_back(std::make_pair("duplicate","second"));
+    m.push_back(std::make_pair(plural_key("x day","x days"),plural_key("יום x","x ימים")));
+    m.push_back(std::make_pair(context_key("context",plural_key("x day","x days")),plural_key("יום בהקשר","ימים בהקשר")));
+    for(int i = 0; i < messages; i++) {
+        if(i % 10 == 0)
+            m.push_back(std::make_pair(plural_key(generated_message(i),"many"),plural_key(generated_translation(i),"רבים")));
+        else
+            m.push_back(std::make_pair(generated_message(i),generated_translation(i)));
+    }
+    return make_mo(m);
+}
+
+template<typename Char>
+void test_generated_catalog(std::locale const &l,int messages)
+{
+    auto const u = [](std::string const &s) { return bl::conv::utf_to_utf<Char>(s); };
+    TEST(bl::translate(u("hello")).str(l)==u("שלום"));
+    TEST(bl::translate(u("context"),u("hello")).str(l)==u("שלום בהקשר"));
+    TEST(bl::translate(u("hello"),u("world")).str(l)==u("עולם בהקשר"));
+    TEST(bl::translate(u("world")).str(l)==u("עולם"));
+    TEST(bl::translate(u("context"),u("world")).str(l)==u("world"));
+    TEST(bl::translate(u("a"),u("bc")).str(l)==u("a bc"));
+    TEST(bl::translate(u("ab"),u("c")).str(l)==u("ab c"));
+    TEST(bl::translate(u("a"),u("b")).str(l)==u("b"));
+    TEST(bl::translate(u("ab")).str(l)==u("hash 1"));
+    TEST(bl::translate(u("bR")).str(l)==u("hash 2"));
+    TEST(bl::translate(u("cB")).str(l)==u("hash 3"));
+    // Has the same hash as well
+    TEST(bl::translate(u("d2")).str(l)==u("d2"));
+    TEST(bl::translate(u("duplicate")).str(l)==u("second"));
+    TEST(bl::translate(u("x day"),u("x days"),1).str(l)==u("יום x"));
+    TEST(bl::translate(u("x day"),u("x days"),5).str(l)==u("x ימים"));
+    TEST(bl::translate(u("context"),u("x day"),u("x days"),5).str(l)==u("ימים בהקשר"));
+    bool all_found = true;
+    for(int i = 0; i < messages; i++) {
+        std::basic_string<Char> const id = u(generated_message(i));
+        std::basic_string<Char> const translation = u(generated_translation(i));
+        if(i % 10 == 0) {
+            all_found = all_found && bl::translate(id,u("many"),1).str(l)==translation
+                && bl::translate(id,u("many"),2).str(l)==u("רבים");
+        }
+        else
+            all_found = all_found && bl::translate(id).str(l)==translation;
+    }
+    TEST(all_found);
+    TEST(bl::translate(u(generated_message(messages))).str(l)==u(generated_message(messages)));
+}
+
 bool iso_8859_8_not_supported = false;
 
 
@@ -373,6 +764,33 @@ void test_main(int argc, char **argv)
             test_ctranslate("context","hello","שלום בהקשר אחר",l,"default");
             test_translate("#hello","#שלום",l,"default");
 
+            std::cout << "    precomputed hashes" << std::endl;
+            test_hashed_translate(l);
+
+            std::cout << "    translation views" << std::endl;
+            test_view_translate<char>(l);
+            test_view_translate<wchar_t>(l);
+
+            std::cout << "    domain handles" << std::endl;
+            test_domain_handle<char>(l);
+            test_domain_handle<wchar_t>(l);
+
+            std::cout << "    message ids" << std::endl;
+            test_message_ids<char>(l);
+            test_message_ids<wchar_t>(l);
+
+            std::cout << "    batch translation" << std::endl;
+            test_batch_translate<char>(l);
+            test_batch_translate<wchar_t>(l);
+            #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+            if(backend=="icu" || backend=="std")
+                test_batch_translate<char16_t>(l);
+            #endif
+            #ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+            if(backend=="icu" || backend=="std")
+                test_batch_translate<char32_t>(l);
+            #endif
+
             std::cout << "    plural forms" << std::endl;
 
             {
@@ -444,6 +862,385 @@ void test_main(int argc, char **argv)
         std::locale l(std::locale::classic(),boost::locale::gnu_gettext::create_messages_facet<char>(info));
         TEST(file_loader_is_actually_called);
         TEST(bl::translate("hello").str(l)=="שלום");
+
+        // The callback is only called by the creating thread even with several domains
+        std::thread::id const this_thread = std::this_thread::get_id();
+        bool other_thread = false;
+        file_loader const loader;
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("simple"));
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("missing"));
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("compiled"));
+        info.callback = [&](std::string const &name,std::string const &encoding) {
+            if(std::this_thread::get_id() != this_thread)
+                other_thread = true;
+            return loader(name,encoding);
+        };
+        l = std::locale(std::locale::classic(),boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        TEST(!other_thread);
+        TEST(bl::translate("hello").str(l,"simple")=="היי");
+    }
+    std::cout << "Testing validation of mo files" << std::endl;
+    {
+        std::vector<char> const original = read_file(std::string(argc==2 ? argv[1] : ".") + "/he/LC_MESSAGES/default.mo");
+        TEST(!original.empty());
+        if(!original.empty()) {
+            std::locale l = mo_file_locale(original);
+            TEST(bl::translate("hello").str(l)=="שלום");
+
+            // Foreign byte order
+            l = mo_file_locale(byteswap_mo(original));
+            TEST(bl::translate("hello").str(l)=="שלום");
+            TEST(bl::translate("x day","x days",2).str(l)=="יומיים");
+            TEST(bl::translate(L"hello").str(l)==bl::conv::to_utf<wchar_t>("שלום","UTF-8"));
+            TEST(bl::translate("untranslated").str(l)=="untranslated");
+
+            // Without a hash table or with one too small for the messages
+            for(uint32_t hash_size = 0; hash_size < 4; hash_size += 3) {
+                std::vector<char> no_hash = original;
+                set_u32(no_hash,20,hash_size);
+                l = mo_file_locale(no_hash);
+                TEST(bl::translate("hello").str(l)=="שלום");
+                TEST(bl::translate("x day","x days",2).str(l)=="יומיים");
+                TEST(bl::translate(L"hello").str(l)==bl::conv::to_utf<wchar_t>("שלום","UTF-8"));
+                TEST(bl::translate("untranslated").str(l)=="untranslated");
+                TEST(bl::translate("context","hello").str(l)=="שלום בהקשר אחר");
+                TEST(BOOST_LOCALE_TRANSLATE_CTX("context","hello").str(l)=="שלום בהקשר אחר");
+            }
+
+            uint32_t const keys = get_u32(original,12);
+            uint32_t const values = get_u32(original,16);
+            uint32_t const hash = get_u32(original,24);
+
+            std::vector<char> broken = original;
+            // Key beyond the end of the file
+            set_u32(broken,keys + 4,uint32_t(original.size()));
+            TEST_THROWS(mo_file_locale(broken),std::runtime_error);
+
+            broken = original;
+            // Translation not NUL terminated
+            set_u32(broken,values,get_u32(original,values) + 1);
+            TEST_THROWS(mo_file_locale(broken),std::runtime_error);
+
+            broken = original;
+            // Invalid message in the hash table
+            set_u32(broken,hash,get_u32(original,8) + 1);
+            TEST_THROWS(mo_file_locale(broken),std::runtime_error);
+
+            broken = original;
+            // Tables beyond the end of the file
+            set_u32(broken,8,0x10000000);
+            TEST_THROWS(mo_file_locale(broken),std::runtime_error);
+            broken = original;
+            set_u32(broken,24,uint32_t(original.size()) - 4);
+            TEST_THROWS(mo_file_locale(broken),std::runtime_error);
+        }
+    }
+    std::cout << "Testing generated catalogs" << std::endl;
+    {
+        int const messages = 5000;
+        std::shared_ptr<bl::gnu_gettext::message_statistics> stats = std::make_shared<bl::gnu_gettext::message_statistics>();
+        std::locale l = mo_file_locale(generated_catalog(messages),stats);
+        test_generated_catalog<char>(l,messages);
+        test_generated_catalog<wchar_t>(l,messages);
+        #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+        test_generated_catalog<char16_t>(l,messages);
+        #endif
+        // The index of the narrow catalog has collisions, so some lookups visit several slots
+        bl::gnu_gettext::message_stats const st = stats->get();
+        TEST_REQUIRE(st.domains.size()==1);
+        unsigned long long longer_probes = 0;
+        for(int i = 1; i < bl::gnu_gettext::message_domain_stats::probe_buckets; i++)
+            longer_probes += st.domains[0].probes[i];
+        TEST(st.domains[0].probes[0] > 0);
+        TEST(longer_probes > 0);
+
+        // Converted on first use, by several threads at once
+        l = mo_file_locale(generated_catalog(messages),nullptr,true);
+        for(int i = 0; i < 2; i++)
+            test_generated_catalog<wchar_t>(l,messages);
+        l = mo_file_locale(generated_catalog(messages),nullptr,true);
+        std::vector<char> all_found(4,false);
+        std::vector<std::thread> threads;
+        for(size_t i = 0; i < all_found.size(); i++) {
+            threads.push_back(std::thread([&,i]() {
+                bool found = true;
+                for(int j = 0; j < messages; j++) {
+                    // Each thread starts elsewhere, so they add messages concurrently
+                    int const n = (j + int(i) * messages / 4) % messages;
+                    std::wstring const id = bl::conv::utf_to_utf<wchar_t>(generated_message(n));
+                    found = found && bl::translate(id).str(l)==bl::conv::utf_to_utf<wchar_t>(generated_translation(n));
+                    // Many different misses, more than are remembered
+                    std::wstring const missing = id + L" missing " + std::to_wstring(i);
+                    found = found && bl::translate(missing).str(l)==missing;
+                }
+                all_found[i] = found;
+            }));
+        }
+        for(size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+        TEST(std::count(all_found.begin(),all_found.end(),true)==int(all_found.size()));
+        test_generated_catalog<wchar_t>(l,messages);
+
+        // Only the header
+        mo_messages header;
+        header.push_back(std::make_pair("","Content-Type: text/plain; charset=UTF-8\n"));
+        l = mo_file_locale(make_mo(header));
+        TEST(bl::translate("hello").str(l)=="hello");
+        TEST(bl::translate("context","hello").str(l)=="hello");
+        TEST(bl::translate("x day","x days",1).str(l)=="x day");
+        TEST(bl::translate("x day","x days",2).str(l)=="x days");
+        TEST(bl::translate(L"hello").str(l)==L"hello");
+        TEST(bl::translate(L"x day",L"x days",2).str(l)==L"x days");
+        #ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+        TEST(bl::translate(u"hello").str(l)==u"hello");
+        #endif
+
+        // Without any messages the encoding is unknown
+        TEST_THROWS(mo_file_locale(make_mo(mo_messages())),std::runtime_error);
+    }
+    std::cout << "Testing many domains and search paths" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.variant = "euro";
+        info.encoding="UTF-8";
+        std::string const path = argc==2 ? argv[1] : "./";
+        info.paths.push_back(path + "/no_such_directory");
+        info.paths.push_back(path);
+        // Not a directory
+        info.paths.push_back(path + "/he/LC_MESSAGES/default.mo");
+
+        // Enough domains to be loaded by several threads
+        // simple is given twice, its last definition is used
+        char const *names[] = { "missing1", "simple", "full", "missing2", "fall", "default", "missing3", "missing5", "simple" };
+        for(char const *name: names)
+            info.domains.push_back(bl::gnu_gettext::messages_info::domain(name));
+
+        for(int i = 0; i < 2; i++) {
+            std::locale l(std::locale::classic(),boost::locale::gnu_gettext::create_messages_facet<char>(info));
+            TEST(bl::translate("hello").str(l,"simple")=="היי");
+            TEST(bl::translate("hello").str(l,"default")=="שלום");
+            TEST(bl::translate("hello").str(l,"missing1")=="hello");
+            TEST(bl::translate("hello").str(l,"missing3")=="hello");
+            TEST(bl::translate("x day","x days",2).str(l,"default")=="יומיים");
+            TEST(bl::translate("x day","x days",2).str(l,"missing2")=="x days");
+            // he_IL is preferred over he
+            TEST(bl::translate("test").str(l,"full")=="he_IL");
+            TEST(bl::translate("test").str(l,"fall")=="he");
+            TEST(bl::translate("hello").str(l,"missing4")=="hello");
+            bl::message_format<char> const &facet = std::use_facet<bl::message_format<char> >(l);
+            TEST(facet.domain("missing1")==0);
+            TEST(facet.domain("full")==2);
+            TEST(facet.domain("missing5")==7);
+            TEST(facet.domain("simple")==8);
+            TEST(facet.domain("missing4")==-1);
+        }
+    }
+    std::cout << "Testing shared catalog store" << std::endl;
+    {
+        boost::locale::generator g;
+        g.add_messages_domain("default");
+        if(argc==2)
+            g.add_messages_path(argv[1]);
+        else
+            g.add_messages_path("./");
+
+        std::locale l1 = g("he_IL.UTF-8");
+        bl::gnu_gettext::catalog_store_stats const before = bl::gnu_gettext::get_catalog_store_stats();
+        TEST(before.catalogs > 0);
+        TEST(before.memory > 0);
+        std::locale l2 = g("he_IL.UTF-8");
+        bl::gnu_gettext::catalog_store_stats const after = bl::gnu_gettext::get_catalog_store_stats();
+        // All catalogs of the 2nd locale are taken from the store
+        TEST(after.hits > before.hits);
+        TEST(after.misses == before.misses);
+        TEST(after.catalogs == before.catalogs);
+        TEST(bl::translate("hello").str(l2)=="שלום");
+        TEST(bl::translate(L"hello").str(l2)==bl::conv::to_utf<wchar_t>("שלום","UTF-8"));
+    }
+    std::cout << "Testing shared catalog headers" << std::endl;
+    {
+        // Release the catalogs held by the global locale, so fall.mo isn't loaded
+        std::locale::global(std::locale::classic());
+        bl::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.encoding = "UTF-8";
+        info.paths.push_back(argc==2 ? argv[1] : "./");
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("fall"));
+
+        bl::gnu_gettext::catalog_store_stats const before = bl::gnu_gettext::get_catalog_store_stats();
+        std::locale l(std::locale::classic(),bl::gnu_gettext::create_messages_facet<char>(info));
+        bl::gnu_gettext::catalog_store_stats const narrow = bl::gnu_gettext::get_catalog_store_stats();
+        // The mo file is loaded and its header parsed
+        TEST(narrow.misses == before.misses + 1);
+        TEST(narrow.catalogs == before.catalogs + 1);
+
+        l = std::locale(l,bl::gnu_gettext::create_messages_facet<wchar_t>(info));
+        bl::gnu_gettext::catalog_store_stats const wide = bl::gnu_gettext::get_catalog_store_stats();
+        // The wide facet uses the same mo file along with its header and only converts the messages
+        TEST(wide.hits == narrow.hits + 1);
+        TEST(wide.misses == narrow.misses + 1);
+        TEST(wide.catalogs == narrow.catalogs + 1);
+
+        TEST(bl::translate("test").str(l,"fall")=="he");
+        TEST(bl::translate(L"test").str(l,"fall")==L"he");
+        TEST(bl::translate("x day","x days",2).str(l,"fall")=="x days");
+        TEST(bl::translate(L"x day",L"x days",1).str(l,"fall")==L"x day");
+    }
+    std::cout << "Testing lazy conversion" << std::endl;
+    {
+        boost::locale::generator g;
+        g.add_messages_domain("simple");
+        if(argc==2)
+            g.add_messages_path(argv[1]);
+        else
+            g.add_messages_path("./");
+        g.set_default_messages_domain("default");
+        g.lazy_message_conversion(true);
+        TEST(g.lazy_message_conversion());
+
+        for(const std::string locale_name: {"he_IL.UTF-8", "he_IL.ISO8859-8"}) {
+            if(iso_8859_8_not_supported && locale_name.find(".ISO") != std::string::npos)
+                continue;
+            std::cout << "  Testing " << locale_name << std::endl;
+            std::locale l = g(locale_name);
+            // Repeat to use the cached results
+            for(int i = 0; i < 2; i++) {
+                test_translate("hello","שלום",l,"default");
+                test_translate("hello","היי",l,"simple");
+                test_translate("untranslated","untranslated",l,"default");
+                test_ctranslate("context","hello","שלום בהקשר אחר",l,"default");
+                test_ntranslate("x day","x days",2,"יומיים",l,"default");
+                test_ntranslate("x day","x days",20,"x יום",l,"default");
+                test_cntranslate("context","x day","x days",1,"בהקשר יום x",l,"default");
+                test_hashed_translate(l);
+            }
+        }
+    }
+    std::cout << "Testing message statistics" << std::endl;
+    {
+        boost::locale::generator g;
+        g.add_messages_domain("simple");
+        if(argc==2)
+            g.add_messages_path(argv[1]);
+        else
+            g.add_messages_path("./");
+        g.set_default_messages_domain("default");
+
+        TEST(!g.message_statistics());
+        TEST(!std::has_facet<bl::gnu_gettext::message_statistics_facet>(g("he_IL.UTF-8")));
+        g.message_statistics(true);
+        TEST(g.message_statistics());
+
+        std::locale l = g("he_IL.UTF-8");
+        TEST(std::has_facet<bl::gnu_gettext::message_statistics_facet>(l));
+        bl::gnu_gettext::message_statistics &stats = std::use_facet<bl::gnu_gettext::message_statistics_facet>(l).statistics();
+
+        TEST(bl::translate("hello").str(l)=="שלום");
+        TEST(bl::translate(L"hello").str(l)==bl::conv::to_utf<wchar_t>("שלום","UTF-8"));
+        TEST(bl::translate("untranslated").str(l)=="untranslated");
+        TEST(bl::translate("context","לא קיים").str(l)=="לא קיים");
+        TEST(bl::translate("x day","x days",2).str(l)=="יומיים");
+        TEST(bl::translate("hello").str(l,"simple")=="היי");
+        // Repeated misses are sampled once
+        TEST(bl::translate("untranslated").str(l)=="untranslated");
+
+        bl::gnu_gettext::message_stats st = stats.get();
+        TEST(st.key_conversions == 0);
+        TEST(st.domains.size() == 2);
+        if(st.domains.size() == 2) {
+            bl::gnu_gettext::message_domain_stats const &def = st.domains[0];
+            TEST(def.name == "default");
+            TEST(def.lookups == 6);
+            TEST(def.hits == 3);
+            TEST(def.misses == 3);
+            TEST(def.plural_evaluations == 1);
+            // The narrow catalog is used directly
+            unsigned long long probes = 0;
+            for(int i = 0; i < bl::gnu_gettext::message_domain_stats::probe_buckets; i++)
+                probes += def.probes[i];
+            TEST(probes == 5);
+            TEST(def.missing.size() == 2);
+            if(def.missing.size() == 2) {
+                TEST(def.missing[0] == std::make_pair(std::string(),std::string("untranslated")));
+                TEST(def.missing[1] == std::make_pair(std::string("context"),std::string("לא קיים")));
+            }
+            bl::gnu_gettext::message_domain_stats const &simple = st.domains[1];
+            TEST(simple.name == "simple");
+            TEST(simple.lookups == 1);
+            TEST(simple.hits == 1);
+            TEST(simple.misses == 0);
+        }
+
+        stats.reset();
+        st = stats.get();
+        TEST(st.domains.size() == 2);
+        TEST(st.domains[0].lookups == 0);
+        TEST(st.domains[0].probes[0] == 0);
+        TEST(st.domains[0].missing.empty());
+
+        if(!iso_8859_8_not_supported) {
+            l = g("he_IL.ISO-8859-8");
+            TEST(bl::translate("לא קיים").str(l)==bl::conv::from_utf("לא קיים","ISO-8859-8"));
+            bl::gnu_gettext::message_statistics &iso_stats = std::use_facet<bl::gnu_gettext::message_statistics_facet>(l).statistics();
+            st = iso_stats.get();
+            TEST(st.key_conversions == 1);
+            TEST(st.cached_key_conversions == 0);
+            TEST(st.domains.size() == 2 && st.domains[0].misses == 1);
+
+            // Untranslated keys are converted once and then taken from the cache
+            TEST(bl::translate("לא קיים").str(l)==bl::conv::from_utf("לא קיים","ISO-8859-8"));
+            TEST(bl::translate("test-בדיקה").str(l)==bl::conv::from_utf("test-בדיקה","ISO-8859-8"));
+            TEST(bl::translate("לא קיים").str(l)==bl::conv::from_utf("לא קיים","ISO-8859-8"));
+            st = iso_stats.get();
+            TEST(st.key_conversions == 4);
+            TEST(st.cached_key_conversions == 2);
+            iso_stats.reset();
+            TEST(iso_stats.get().cached_key_conversions == 0);
+        }
+    }
+    std::cout << "Testing compiled catalogs" << std::endl;
+    {
+        // he/LC_MESSAGES/compiled.mcat is created from default.po by
+        // compile_catalog -c ISO-8859-8 default.po compiled.mcat
+        // on a little endian machine, there is no compiled.mo
+        uint32_t const one = 1;
+        if(*reinterpret_cast<char const *>(&one) != 1) {
+            std::cout << "  Big endian platform, skipping" << std::endl;
+        }
+        else {
+            boost::locale::generator g;
+            g.add_messages_domain("compiled");
+            if(argc==2)
+                g.add_messages_path(argv[1]);
+            else
+                g.add_messages_path("./");
+
+            for(const std::string locale_name: {"he_IL.UTF-8", "he_IL.ISO8859-8"}) {
+                if(iso_8859_8_not_supported && locale_name.find(".ISO") != std::string::npos)
+                    continue;
+                std::cout << "  Testing " << locale_name << std::endl;
+                std::locale l = g(locale_name);
+                test_translate("hello","שלום",l,"compiled");
+                test_translate("#hello","#שלום",l,"compiled");
+                test_translate("untranslated","untranslated",l,"compiled");
+                test_ctranslate("context","hello","שלום בהקשר אחר",l,"compiled");
+                test_ctranslate("context","untranslated","untranslated",l,"compiled");
+                test_ntranslate("x day","x days",1,"יום x",l,"compiled");
+                test_ntranslate("x day","x days",2,"יומיים",l,"compiled");
+                test_ntranslate("x day","x days",3,"x ימים",l,"compiled");
+                test_ntranslate("x day","x days",20,"x יום",l,"compiled");
+                test_ntranslate("x untranslated","x untranslated",1,"x untranslated",l,"compiled");
+                test_cntranslate("context","x day","x days",1,"בהקשר יום x",l,"compiled");
+                test_cntranslate("context","x day","x days",2,"בהקשר יומיים",l,"compiled");
+            }
+            std::locale l = g("he_IL.UTF-8");
+            TEST(bl::dgettext("compiled","בדיקה",l)=="test");
+            TEST(bl::dgettext("compiled","לא קיים",l)=="לא קיים");
+            std::wstring wtest = bl::conv::to_utf<wchar_t>("בדיקה","UTF-8");
+            TEST(bl::dgettext("compiled",wtest.c_str(),l)==L"test");
+        }
     }
     if(iso_8859_8_not_supported)
     {
@@ -477,6 +1274,30 @@ void test_main(int argc, char **argv)
 
             // conversion with substitution
             TEST(bl::gettext("test-あにま-בדיקה",l)==bl::conv::from_utf("test--בדיקה","ISO-8859-8"));
+            // converted keys are cached, the result of a cached conversion is the same
+            TEST(bl::gettext("test-あにま-בדיקה",l)==bl::conv::from_utf("test--בדיקה","ISO-8859-8"));
+            TEST(bl::gettext("test-בדיקה",l)==bl::conv::from_utf("test-בדיקה","ISO-8859-8"));
+
+            // converted original strings of a batch
+            bl::message_batch::request const requests[] = {
+                { 0, "test-あにま-בדיקה", 0, 0 },
+                { 0, "hello", 0, 0 },
+                { 0, "לא קיים", 0, 0 },
+            };
+            char const *results[3];
+            bl::message_batch batch(l);
+            TEST(batch.translate(requests,3,results)==1);
+            TEST(results[0]==bl::conv::from_utf("test--בדיקה","ISO-8859-8"));
+            TEST(results[1]==bl::conv::from_utf("שלום","ISO-8859-8"));
+            TEST(results[2]==bl::conv::from_utf("לא קיים","ISO-8859-8"));
+
+            std::string buffer;
+            char const *view = bl::translate("לא קיים").view(l,buffer);
+            TEST(view==bl::conv::from_utf("לא קיים","ISO-8859-8"));
+            // The converted string is kept by the locale, so it isn't copied again
+            std::string other;
+            TEST(bl::translate("לא קיים").view(l,other)==view);
+            TEST(other.empty());
         }
 
         std::cout << "  `ANSI' keys" << std::endl;
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2026 agent
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include <limits>
+#include <sstream>
+#include <string>
+#include "../src/boost/locale/shared/mo_lambda.hpp"
+#include "boostLocale/test/unit_test.hpp"
+
+using boost::locale::gnu_gettext::lambda::compile;
+using boost::locale::gnu_gettext::lambda::interned_expressions;
+using boost::locale::gnu_gettext::lambda::plural_ptr;
+
+//
+// Compare the compiled expression with the same expression evaluated by C++ for the usual numbers,
+// negative ones and a few large ones
+//
+template<typename Reference>
+void test_expression(char const *expr,Reference ref,bool large_numbers = true)
+{
+    plural_ptr p = compile(expr);
+    TEST_REQUIRE(p);
+    int const large[] = { 1000000, 123456789, std::numeric_limits<int>::max(), std::numeric_limits<int>::min() + 1 };
+    bool same = true;
+    for(int n = -2000; n <= 2000 && same; n++) {
+        if((*p)(n) != ref(n)) {
+            std::cerr << "  " << expr << " differs for n=" << n << std::endl;
+            same = false;
+        }
+    }
+    for(int n: large) {
+        if(same && large_numbers && (*p)(n) != ref(n)) {
+            std::cerr << "  " << expr << " differs for n=" << n << std::endl;
+            same = false;
+        }
+    }
+    TEST(same);
+}
+
+void test_plural_forms()
+{
+    std::cout << "- Plural forms of real languages" << std::endl;
+    test_expression("(n != 1)",[](int n) { return n != 1; });
+    test_expression("(n%10==1 && n%100!=11 ? 0 : n%10>=2 && n%10<=4 && (n%100<10 || n%100>=20) ? 1 : 2)",[](int n) {
+        return n%10==1 && n%100!=11 ? 0 : n%10>=2 && n%10<=4 && (n%100<10 || n%100>=20) ? 1 : 2;
+    });
+    test_expression("(n==1 ? 0 : n%10>=2 && n%10<=4 && (n%100<10 || n%100>=20) ? 1 : 2)",[](int n) {
+        return n==1 ? 0 : n%10>=2 && n%10<=4 && (n%100<10 || n%100>=20) ? 1 : 2;
+    });
+    test_expression("(n==0 ? 0 : n==1 ? 1 : n==2 ? 2 : n%100>=3 && n%100<=10 ? 3 : n%100>=11 ? 4 : 5)",[](int n) {
+        return n==0 ? 0 : n==1 ? 1 : n==2 ? 2 : n%100>=3 && n%100<=10 ? 3 : n%100>=11 ? 4 : 5;
+    });
+}
+
+void test_operators()
+{
+    std::cout << "- Operators" << std::endl;
+    // Nested conditional operators in both branches
+    test_expression("n < 10 ? (n < 5 ? n < 2 ? 0 : 1 : 2) : n < 100 ? n % 2 ? 3 : 4 : 5",[](int n) {
+        return n < 10 ? (n < 5 ? n < 2 ? 0 : 1 : 2) : n < 100 ? n % 2 ? 3 : 4 : 5;
+    });
+    test_expression("(n > 5 ? n - 5 : 0) ? (n > 8 ? 3 : 4) : 5",[](int n) { return (n > 5 ? n - 5 : 0) ? (n > 8 ? 3 : 4) : 5; });
+    test_expression("n == 1 || n == 2 && n == 3",[](int n) { return n == 1 || (n == 2 && n == 3); });
+    test_expression("!n + ~n - -n * 2",[](int n) { return !n + ~n - -n * 2; },false);
+    test_expression("(n & 6) ^ ((n & 255) | 1) << 2 >> 1",[](int n) { return (n & 6) ^ (((n & 255) | 1) << 2 >> 1); });
+    test_expression("n >= 3 != n <= 5",[](int n) { return (n >= 3) != (n <= 5); });
+
+    // The right operand of && and || doesn't change the result when the left one decides it,
+    // even if it divides by zero
+    test_expression("n != 0 && 100 / n > 10",[](int n) { return n != 0 && 100 / n > 10; });
+    test_expression("n == 0 || 100 % n == 0",[](int n) { return n == 0 || 100 % n == 0; });
+    test_expression("0 && n",[](int) { return 0; });
+    test_expression("1 || n",[](int) { return 1; });
+
+    // Division by zero gives 0
+    test_expression("n / 0",[](int) { return 0; });
+    test_expression("n % 0",[](int) { return 0; });
+    test_expression("7 / (n - 3) + 2",[](int n) { return n == 3 ? 2 : 7 / (n - 3) + 2; });
+    test_expression("(n + 11) % (n % 4)",[](int n) { return n % 4 == 0 ? 0 : (n + 11) % (n % 4); },false);
+}
+
+void test_deep_expression()
+{
+    std::cout << "- Deep expressions" << std::endl;
+    // n+(n+(...(n+1)...)) keeps all n on the stack, more than fit the stack used for usual expressions
+    int const depth = 100;
+    std::ostringstream expr;
+    for(int i = 0; i < depth; i++)
+        expr << "n+(";
+    expr << "1";
+    for(int i = 0; i < depth; i++)
+        expr << ")";
+    std::string const deep = expr.str();
+    // The results would overflow for large numbers
+    test_expression(deep.c_str(),[](int n) { return depth * n + 1; },false);
+
+    // Small results are precomputed using the same evaluation
+    std::string const deep_mod = "(" + deep + ") % 7";
+    test_expression(deep_mod.c_str(),[](int n) { return (depth * n + 1) % 7; },false);
+}
+
+void test_invalid()
+{
+    std::cout << "- Invalid expressions" << std::endl;
+    TEST(!compile(""));
+    TEST(!compile("n +"));
+    TEST(!compile("(n"));
+    TEST(!compile("n)"));
+    TEST(!compile("n ? 1"));
+    TEST(!compile("n ? 1 : "));
+    TEST(!compile("n 1"));
+    TEST(!compile("x"));
+}
+
+void test_interning()
+{
+    std::cout << "- Shared expressions" << std::endl;
+    // The expressions compiled by the other tests aren't used anymore and are removed now
+    plural_ptr p = compile("(n%10==1 ? 0 : 1)");
+    TEST_REQUIRE(p);
+    TEST(interned_expressions() == 1);
+
+    // Expressions differing only in white space share one object
+    plural_ptr same = compile(" (n%10==1  ?\t0 :\n1) ");
+    TEST(same == p);
+    TEST(interned_expressions() == 1);
+    plural_ptr other = compile("(n%10==2 ? 0 : 1)");
+    TEST_REQUIRE(other);
+    TEST(other != p);
+    TEST(interned_expressions() == 2);
+
+    // An expression no longer used is compiled again, its old entry is replaced
+    p.reset();
+    same.reset();
+    p = compile("(n%10==1 ? 0 : 1)");
+    TEST_REQUIRE(p);
+    TEST((*p)(21) == 0 && (*p)(22) == 1);
+    TEST(interned_expressions() == 2);
+
+    // Entries of unused expressions are removed when another one is compiled
+    other.reset();
+    plural_ptr third = compile("(n%10==3 ? 0 : 1)");
+    TEST_REQUIRE(third);
+    TEST(interned_expressions() == 2);
+    TEST(compile("(n%10==1 ? 0 : 1)") == p);
+
+    // Invalid expressions aren't stored
+    TEST(!compile("(n%10==4 ? 0"));
+    TEST(interned_expressions() == 2);
+}
+
+void test_main(int /*argc*/, char** /*argv*/)
+{
+    test_plural_forms();
+    test_operators();
+    test_deep_expression();
+    test_invalid();
+    test_interning();
+}
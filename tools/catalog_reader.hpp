@@ -0,0 +1,354 @@
+//
+// Copyright (c) 2026 agent
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#ifndef BOOST_LOCALE_TOOLS_CATALOG_READER_HPP_INCLUDED
+#define BOOST_LOCALE_TOOLS_CATALOG_READER_HPP_INCLUDED
+
+//
+// Reading GNU gettext catalogs (.po or .mo files), shared by the tools
+//
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+namespace {
+
+    struct message {
+        std::string key;                    // "context\4id" or "id"
+        std::string plural_id;              // Empty if the message has no plural forms
+        std::vector<std::string> forms;     // Translations, one per plural form
+    };
+
+    struct catalog {
+        std::string charset;
+        std::string plural;
+        std::vector<message> messages;
+    };
+
+    std::string extract(std::string const &meta,std::string const &key,char const *separator)
+    {
+        size_t pos=meta.find(key);
+        if(pos == std::string::npos)
+            return "";
+        pos+=key.size();
+        size_t end_pos = meta.find_first_of(separator,pos);
+        return meta.substr(pos,end_pos - pos);
+    }
+
+    void set_header(catalog &cat,std::string const &header)
+    {
+        cat.charset = extract(header,"charset="," \r\n;");
+        cat.plural = extract(header,"plural=","\r\n;");
+    }
+
+    std::vector<std::string> split_forms(std::string const &value)
+    {
+        std::vector<std::string> forms;
+        size_t begin = 0;
+        for(;;) {
+            size_t end = value.find('\0',begin);
+            forms.push_back(value.substr(begin,end - begin));
+            if(end == std::string::npos)
+                break;
+            begin = end + 1;
+        }
+        return forms;
+    }
+
+    //
+    // Reading mo files
+    //
+
+    class mo_reader {
+    public:
+        mo_reader(std::string const &data): data_(data), swap_(false)
+        {
+            uint32_t magic = get(0);
+            if(magic == 0xde120495)
+                swap_ = true;
+            else if(magic != 0x950412de)
+                throw std::runtime_error("invalid mo file");
+        }
+
+        void read(catalog &cat) const
+        {
+            uint32_t size = get(8);
+            uint32_t keys = get(12);
+            uint32_t translations = get(16);
+            for(uint32_t i = 0;i < size;i++) {
+                std::string key = string_at(keys + 8 * i);
+                std::string value = string_at(translations + 8 * i);
+                // The key of plural messages holds the plural id after the NUL
+                size_t plural = key.find('\0');
+                message msg;
+                if(plural != std::string::npos)
+                    msg.plural_id = key.substr(plural + 1);
+                key = key.substr(0,plural);
+                if(key.empty()) {
+                    set_header(cat,value);
+                    continue;
+                }
+                msg.key = key;
+                msg.forms = split_forms(value);
+                cat.messages.push_back(msg);
+            }
+        }
+
+    private:
+        uint32_t get(uint64_t offset) const
+        {
+            if(offset + 4 > data_.size())
+                throw std::runtime_error("invalid mo file");
+            uint32_t v;
+            memcpy(&v,data_.data() + offset,4);
+            if(swap_)
+                v = ((v & 0xFF) << 24) | ((v & 0xFF00) << 8) | ((v & 0xFF0000) >> 8) | ((v & 0xFF000000) >> 24);
+            return v;
+        }
+
+        std::string string_at(uint64_t record) const
+        {
+            uint32_t length = get(record);
+            uint32_t offset = get(record + 4);
+            if(uint64_t(offset) + length > data_.size())
+                throw std::runtime_error("invalid mo file");
+            return data_.substr(offset,length);
+        }
+
+        std::string const &data_;
+        bool swap_;
+    };
+
+    //
+    // Reading po files
+    //
+
+    class po_reader {
+    public:
+        po_reader(std::string const &data,bool untranslated): untranslated_(untranslated), line_no_(0)
+        {
+            std::istringstream ss(data);
+            std::string line;
+            while(std::getline(ss,line)) {
+                if(!line.empty() && line[line.size() - 1] == '\r')
+                    line.erase(line.size() - 1);
+                lines_.push_back(line);
+            }
+        }
+
+        void read(catalog &cat)
+        {
+            entry e;
+            std::string *current = 0;
+            for(line_no_ = 1;line_no_ <= lines_.size();line_no_++) {
+                std::string line = trim(lines_[line_no_ - 1]);
+                if(line.empty())
+                    continue;
+                if(line[0] == '#') {
+                    // Obsolete entries start with #~ and are ignored
+                    if(line.compare(0,2,"#,") == 0 && line.find("fuzzy") != std::string::npos) {
+                        flush(cat,e);
+                        e.fuzzy = true;
+                    }
+                    continue;
+                }
+                if(line[0] == '"') {
+                    if(!current)
+                        error("unexpected string");
+                    *current += parse_string(line);
+                    continue;
+                }
+                size_t space = line.find_first_of(" \t");
+                if(space == std::string::npos)
+                    error("expected a string after the keyword");
+                std::string keyword = line.substr(0,space);
+                std::string value = parse_string(trim(line.substr(space)));
+                if(keyword == "msgctxt") {
+                    if(e.has_msgstr || e.has_msgid)
+                        flush(cat,e);
+                    e.has_context = true;
+                    e.context = value;
+                    current = &e.context;
+                }
+                else if(keyword == "msgid") {
+                    if(e.has_msgstr || e.has_msgid)
+                        flush(cat,e);
+                    e.has_msgid = true;
+                    e.id = value;
+                    current = &e.id;
+                }
+                else if(keyword == "msgid_plural") {
+                    e.plural_id = value;
+                    current = &e.plural_id;
+                }
+                else if(keyword.compare(0,6,"msgstr") == 0) {
+                    size_t index = 0;
+                    if(keyword.size() > 6) {
+                        if(keyword[6] != '[' || keyword[keyword.size() - 1] != ']')
+                            error("invalid keyword " + keyword);
+                        index = atoi(keyword.substr(7,keyword.size() - 8).c_str());
+                    }
+                    if(e.forms.size() <= index)
+                        e.forms.resize(index + 1);
+                    e.forms[index] = value;
+                    e.has_msgstr = true;
+                    current = &e.forms[index];
+                }
+                else
+                    error("unknown keyword " + keyword);
+            }
+            flush(cat,e);
+        }
+
+    private:
+        struct entry {
+            entry(): fuzzy(false), has_context(false), has_msgid(false), has_msgstr(false) {}
+            bool fuzzy;
+            bool has_context;
+            bool has_msgid;
+            bool has_msgstr;
+            std::string context;
+            std::string id;
+            std::string plural_id;
+            std::vector<std::string> forms;
+        };
+
+        void flush(catalog &cat,entry &e)
+        {
+            if(e.has_msgid) {
+                if(!e.has_msgstr)
+                    error("missing msgstr");
+                bool translated = false;
+                for(size_t i = 0;i < e.forms.size();i++)
+                    translated = translated || !e.forms[i].empty();
+                if(e.id.empty() && !e.has_context)
+                    set_header(cat,e.forms[0]);
+                // Like msgfmt skip fuzzy and untranslated messages
+                else if(untranslated_ || (translated && !e.fuzzy)) {
+                    message msg;
+                    msg.key = e.has_context ? e.context + '\4' + e.id : e.id;
+                    msg.plural_id = e.plural_id;
+                    msg.forms = e.forms;
+                    cat.messages.push_back(msg);
+                }
+            }
+            e = entry();
+        }
+
+        static std::string trim(std::string const &s)
+        {
+            size_t begin = s.find_first_not_of(" \t");
+            if(begin == std::string::npos)
+                return std::string();
+            size_t end = s.find_last_not_of(" \t");
+            return s.substr(begin,end + 1 - begin);
+        }
+
+        std::string parse_string(std::string const &s) const
+        {
+            if(s.size() < 2 || s[0] != '"' || s[s.size() - 1] != '"')
+                error("expected a quoted string");
+            std::string result;
+            for(size_t i = 1;i < s.size() - 1;i++) {
+                char c = s[i];
+                if(c == '"')
+                    error("unexpected quote");
+                if(c != '\\') {
+                    result += c;
+                    continue;
+                }
+                if(++i >= s.size() - 1)
+                    error("invalid escape sequence");
+                c = s[i];
+                switch(c) {
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'r': result += '\r'; break;
+                case 'a': result += '\a'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'v': result += '\v'; break;
+                case '\\':
+                case '"':
+                case '\'':
+                case '?':
+                    result += c;
+                    break;
+                case 'x':
+                    {
+                        unsigned value = 0;
+                        size_t digits = 0;
+                        while(i + 1 < s.size() - 1 && isxdigit(static_cast<unsigned char>(s[i + 1]))) {
+                            char d = s[++i];
+                            value = value * 16 + (isdigit(static_cast<unsigned char>(d)) ? d - '0' : (tolower(d) - 'a' + 10));
+                            digits++;
+                        }
+                        if(digits == 0)
+                            error("invalid escape sequence");
+                        result += static_cast<char>(value);
+                    }
+                    break;
+                default:
+                    if('0' <= c && c <= '7') {
+                        unsigned value = c - '0';
+                        for(int n = 0;n < 2 && i + 1 < s.size() - 1 && '0' <= s[i + 1] && s[i + 1] <= '7';n++)
+                            value = value * 8 + (s[++i] - '0');
+                        result += static_cast<char>(value);
+                    }
+                    else
+                        error("invalid escape sequence");
+                }
+            }
+            return result;
+        }
+
+        void error(std::string const &msg) const
+        {
+            std::ostringstream ss;
+            ss << "line " << line_no_ << ": " << msg;
+            throw std::runtime_error(ss.str());
+        }
+
+        bool untranslated_;
+        std::vector<std::string> lines_;
+        size_t line_no_;
+    };
+
+    std::string read_file(std::string const &name)
+    {
+        std::ifstream f(name.c_str(),std::ios::binary);
+        if(!f)
+            throw std::runtime_error("can't open " + name);
+        return std::string(std::istreambuf_iterator<char>(f),std::istreambuf_iterator<char>());
+    }
+
+    //
+    // Read the catalog in \a data, untranslated messages of po files are skipped like msgfmt does
+    // unless \a untranslated is set
+    //
+    void read_catalog(std::string const &data,catalog &cat,bool untranslated = false)
+    {
+        uint32_t magic = 0;
+        if(data.size() >= 4)
+            memcpy(&magic,data.data(),4);
+        if(magic == 0x950412de || magic == 0xde120495)
+            mo_reader(data).read(cat);
+        else
+            po_reader(data,untranslated).read(cat);
+    }
+
+} // anon
+
+#endif
@@ -0,0 +1,365 @@
+//
+// Copyright (c) 2026 agent
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+//
+// Compiles GNU gettext catalogs (.po or .mo files) to the compiled catalog format
+// that Boost.Locale loads in place of the mo file with the same name
+//
+
+#include <boost/locale/encoding.hpp>
+#include <boost/locale/utf.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/locale/shared/compiled_catalog.hpp"
+#include "catalog_reader.hpp"
+
+namespace compiled = boost::locale::gnu_gettext::compiled;
+namespace conv = boost::locale::conv;
+
+namespace {
+
+    //
+    // Writing the compiled catalog
+    //
+
+    class writer {
+    public:
+        size_t size() const
+        {
+            return data_.size();
+        }
+
+        void align(size_t n)
+        {
+            while(data_.size() % n)
+                data_ += '\0';
+        }
+
+        uint32_t offset() const
+        {
+            if(data_.size() > 0xFFFFFFFFu)
+                throw std::runtime_error("the catalog is too big");
+            return uint32_t(data_.size());
+        }
+
+        void put(uint32_t v)
+        {
+            data_.append(reinterpret_cast<char const *>(&v),4);
+        }
+
+        void put(size_t offset,uint32_t v)
+        {
+            memcpy(&data_[offset],&v,4);
+        }
+
+        template<typename CharType>
+        void put(std::basic_string<CharType> const &s)
+        {
+            data_.append(reinterpret_cast<char const *>(s.c_str()),(s.size() + 1) * sizeof(CharType));
+        }
+
+        void append(std::string const &raw)
+        {
+            data_ += raw;
+        }
+
+        std::string const &data() const
+        {
+            return data_;
+        }
+
+    private:
+        std::string data_;
+    };
+
+    std::string normalize_charset(std::string const &charset)
+    {
+        std::string result;
+        for(size_t i = 0;i < charset.size();i++) {
+            char c = charset[i];
+            if('A' <= c && c <= 'Z')
+                result += char(c - 'A' + 'a');
+            else if(('a' <= c && c <= 'z') || ('0' <= c && c <= '9'))
+                result += c;
+        }
+        return result;
+    }
+
+    //
+    // Find the seeds of a minimal perfect hash using hash and displace: the keys are distributed to
+    // buckets and the buckets, largest first, get the first seed that places all their keys to free slots
+    //
+    std::vector<uint32_t> build_perfect_hash(std::vector<uint64_t> const &hashes,uint32_t buckets,std::vector<uint32_t> &slots)
+    {
+        uint32_t messages = uint32_t(hashes.size());
+        std::vector<std::vector<uint32_t> > members(buckets);
+        for(uint32_t i = 0;i < messages;i++)
+            members[compiled::bucket(hashes[i],buckets)].push_back(i);
+        std::vector<uint32_t> order(buckets);
+        for(uint32_t i = 0;i < buckets;i++)
+            order[i] = i;
+        std::stable_sort(order.begin(),order.end(),[&](uint32_t a,uint32_t b) {
+            return members[a].size() > members[b].size();
+        });
+
+        std::vector<uint32_t> seeds(buckets);
+        std::vector<bool> used(messages);
+        std::vector<uint32_t> candidate;
+        slots.resize(messages);
+        for(uint32_t b = 0;b < buckets;b++) {
+            std::vector<uint32_t> const &keys = members[order[b]];
+            if(keys.empty())
+                break;
+            for(uint32_t seed = 0;;seed++) {
+                if(seed == (1u << 24))
+                    throw std::runtime_error("failed to build the perfect hash");
+                candidate.clear();
+                bool ok = true;
+                for(size_t k = 0;ok && k < keys.size();k++) {
+                    uint32_t slot = compiled::slot(hashes[keys[k]],seed,messages);
+                    ok = !used[slot] && std::find(candidate.begin(),candidate.end(),slot) == candidate.end();
+                    candidate.push_back(slot);
+                }
+                if(!ok)
+                    continue;
+                for(size_t k = 0;k < keys.size();k++) {
+                    used[candidate[k]] = true;
+                    slots[keys[k]] = candidate[k];
+                }
+                seeds[order[b]] = seed;
+                break;
+            }
+        }
+        return seeds;
+    }
+
+    struct payload_data {
+        std::string charset;
+        unsigned unit_size;
+        std::vector<uint32_t> entries;  // entry_size values per slot
+        std::vector<uint32_t> forms;
+        std::string data;               // Code units of all translations
+    };
+
+    template<typename CharType>
+    void add_translation(payload_data &p,uint32_t slot,std::vector<std::basic_string<CharType> > const &forms)
+    {
+        std::basic_string<CharType> value;
+        uint32_t forms_index = uint32_t(p.forms.size());
+        for(size_t i = 0;i < forms.size();i++) {
+            if(i > 0) {
+                value += CharType(0);
+                p.forms.push_back(uint32_t(value.size()));
+            }
+            value += forms[i];
+        }
+        uint32_t *entry = &p.entries[compiled::entry_size * slot];
+        entry[compiled::entry_value_offset] = uint32_t(p.data.size() / sizeof(CharType));
+        entry[compiled::entry_value_length] = uint32_t(value.size());
+        entry[compiled::entry_forms_index] = forms_index;
+        entry[compiled::entry_forms_count] = uint32_t(p.forms.size()) - forms_index;
+        p.data.append(reinterpret_cast<char const *>(value.c_str()),(value.size() + 1) * sizeof(CharType));
+    }
+
+    std::string compile(catalog &cat,std::vector<std::string> const &charsets)
+    {
+        if(cat.charset.empty())
+            throw std::runtime_error("the catalog does not specify its charset");
+        bool utf8 = normalize_charset(cat.charset) == "utf8";
+
+        // Keys are stored in UTF-8
+        uint32_t flags = compiled::flag_ascii_keys;
+        for(size_t i = 0;i < cat.messages.size();i++) {
+            message &msg = cat.messages[i];
+            if(!utf8)
+                msg.key = conv::to_utf<char>(msg.key,cat.charset,conv::stop);
+            for(size_t j = 0;j < msg.key.size();j++) {
+                if(static_cast<unsigned char>(msg.key[j]) >= 0x80)
+                    flags &= ~compiled::flag_ascii_keys;
+            }
+        }
+
+        // Sorted messages give the same output for po and mo files
+        std::sort(cat.messages.begin(),cat.messages.end(),[](message const &a,message const &b) {
+            return a.key < b.key;
+        });
+        for(size_t i = 1;i < cat.messages.size();i++) {
+            if(cat.messages[i - 1].key == cat.messages[i].key)
+                throw std::runtime_error("duplicate message \"" + cat.messages[i].key + "\"");
+        }
+
+        uint32_t messages = uint32_t(cat.messages.size());
+        uint32_t buckets = messages / 4 + 1;
+        std::vector<uint64_t> hashes(messages);
+        for(uint32_t i = 0;i < messages;i++) {
+            compiled::key_hash h;
+            std::string const &key = cat.messages[i].key;
+            h.add(key.c_str(),key.c_str() + key.size());
+            hashes[i] = h.value();
+        }
+        std::vector<uint32_t> slots;
+        std::vector<uint32_t> seeds = build_perfect_hash(hashes,buckets,slots);
+
+        std::vector<payload_data> payloads(charsets.size());
+        for(size_t p = 0;p < charsets.size();p++) {
+            payload_data &pd = payloads[p];
+            pd.charset = charsets[p];
+            std::string name = normalize_charset(charsets[p]);
+            pd.unit_size = name == "utf16" ? 2 : name == "utf32" ? 4 : 1;
+            pd.entries.resize(compiled::entry_size * messages);
+            for(uint32_t i = 0;i < messages;i++) {
+                std::vector<std::string> const &forms = cat.messages[i].forms;
+                if(pd.unit_size == 1) {
+                    std::vector<std::string> converted;
+                    for(size_t f = 0;f < forms.size();f++)
+                        converted.push_back(conv::between(forms[f],charsets[p],cat.charset,conv::stop));
+                    add_translation(pd,slots[i],converted);
+                }
+                else {
+                    std::vector<std::u16string> utf16;
+                    std::vector<std::u32string> utf32;
+                    for(size_t f = 0;f < forms.size();f++) {
+                        std::string form = utf8 ? forms[f] : conv::to_utf<char>(forms[f],cat.charset,conv::stop);
+                        if(pd.unit_size == 2)
+                            utf16.push_back(conv::utf_to_utf<char16_t>(form,conv::stop));
+                        else
+                            utf32.push_back(conv::utf_to_utf<char32_t>(form,conv::stop));
+                    }
+                    if(pd.unit_size == 2)
+                        add_translation(pd,slots[i],utf16);
+                    else
+                        add_translation(pd,slots[i],utf32);
+                }
+            }
+        }
+
+        writer out;
+        for(int i = 0;i < compiled::header_size;i++)
+            out.put(0);
+        out.put(4 * compiled::header_magic,compiled::magic);
+        out.put(4 * compiled::header_version,compiled::version);
+        out.put(4 * compiled::header_messages,messages);
+        out.put(4 * compiled::header_buckets,buckets);
+        out.put(4 * compiled::header_flags,flags);
+        out.put(4 * compiled::header_payloads,uint32_t(payloads.size()));
+
+        if(!cat.plural.empty()) {
+            out.put(4 * compiled::header_plural_offset,out.offset());
+            out.put(cat.plural);
+            out.align(4);
+        }
+
+        out.put(4 * compiled::header_seeds_offset,out.offset());
+        for(uint32_t i = 0;i < buckets;i++)
+            out.put(seeds[i]);
+
+        out.put(4 * compiled::header_keys_offset,out.offset());
+        size_t keys_table = out.size();
+        for(uint32_t i = 0;i < messages;i++) {
+            out.put(0);
+            out.put(0);
+        }
+        for(uint32_t i = 0;i < messages;i++) {
+            std::string const &key = cat.messages[i].key;
+            out.put(keys_table + 8 * slots[i],out.offset());
+            out.put(keys_table + 8 * slots[i] + 4,uint32_t(key.size()));
+            out.put(key);
+        }
+        out.align(4);
+
+        out.put(4 * compiled::header_payloads_offset,out.offset());
+        size_t directory = out.size();
+        for(size_t p = 0;p < payloads.size() * compiled::payload_size;p++)
+            out.put(0);
+        for(size_t p = 0;p < payloads.size();p++) {
+            payload_data const &pd = payloads[p];
+            size_t record = directory + 4 * compiled::payload_size * p;
+            out.put(record + 4 * compiled::payload_charset_offset,out.offset());
+            out.put(pd.charset);
+            out.align(4);
+            out.put(record + 4 * compiled::payload_unit_size,pd.unit_size);
+            out.put(record + 4 * compiled::payload_entries_offset,out.offset());
+            for(size_t i = 0;i < pd.entries.size();i++)
+                out.put(pd.entries[i]);
+            out.put(record + 4 * compiled::payload_forms_offset,out.offset());
+            out.put(record + 4 * compiled::payload_forms_size,uint32_t(pd.forms.size()));
+            for(size_t i = 0;i < pd.forms.size();i++)
+                out.put(pd.forms[i]);
+            out.put(record + 4 * compiled::payload_data_offset,out.offset());
+            out.put(record + 4 * compiled::payload_data_size,uint32_t(pd.data.size() / pd.unit_size));
+            out.append(pd.data);
+            out.align(4);
+        }
+        // The library requires the file to end with 0
+        out.put(0);
+        out.offset();
+        return out.data();
+    }
+
+    void usage()
+    {
+        std::cerr <<
+            "Usage: compile_catalog [-c charset]... input output\n"
+            "\n"
+            "Compiles the GNU gettext catalog input (.po or .mo file) to output.\n"
+            "Name the output like the mo file with the extension .mcat, for example\n"
+            "de/LC_MESSAGES/app.mcat, to make Boost.Locale use it instead of app.mo.\n"
+            "\n"
+            "The translations are stored in UTF-8, UTF-16 and UTF-32 (used for wide\n"
+            "characters), each -c adds an encoding for narrow characters.\n";
+    }
+
+} // anon
+
+int main(int argc,char **argv)
+{
+    std::vector<std::string> charsets;
+    charsets.push_back("UTF-8");
+    charsets.push_back("UTF-16");
+    charsets.push_back("UTF-32");
+    std::vector<std::string> files;
+    for(int i = 1;i < argc;i++) {
+        std::string arg = argv[i];
+        if(arg == "-c" && i + 1 < argc) {
+            std::string charset = argv[++i];
+            bool found = false;
+            for(size_t j = 0;j < charsets.size();j++)
+                found = found || normalize_charset(charsets[j]) == normalize_charset(charset);
+            if(!found)
+                charsets.push_back(charset);
+        }
+        else if(arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        }
+        else
+            files.push_back(arg);
+    }
+    if(files.size() != 2) {
+        usage();
+        return 1;
+    }
+    try {
+        catalog cat;
+        read_catalog(read_file(files[0]),cat);
+        std::string output = compile(cat,charsets);
+        std::ofstream f(files[1].c_str(),std::ios::binary);
+        f.write(output.data(),output.size());
+        if(!f)
+            throw std::runtime_error("failed to write " + files[1]);
+    }
+    catch(std::exception const &e) {
+        std::cerr << files[0] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,252 @@
+//
+// Copyright (c) 2026 agent
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+//
+// Generates a C++ header with integer ids of the messages of a GNU gettext catalog (.po, .pot or .mo file)
+// to be used with boost::locale::message_ids
+//
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catalog_reader.hpp"
+
+namespace {
+
+    struct key {
+        std::string context;
+        std::string id;
+        std::string plural;
+        bool has_context;
+
+        bool operator<(key const &other) const
+        {
+            if(has_context != other.has_context)
+                return !has_context;
+            if(context != other.context)
+                return context < other.context;
+            return id < other.id;
+        }
+    };
+
+    std::vector<key> get_keys(catalog const &cat)
+    {
+        std::vector<key> keys;
+        for(size_t i = 0;i < cat.messages.size();i++) {
+            message const &msg = cat.messages[i];
+            key k;
+            size_t eot = msg.key.find('\4');
+            k.has_context = eot != std::string::npos;
+            k.context = k.has_context ? msg.key.substr(0,eot) : std::string();
+            k.id = k.has_context ? msg.key.substr(eot + 1) : msg.key;
+            k.plural = msg.plural_id;
+            keys.push_back(k);
+        }
+        // Sorted, so the ids don't depend on the order of the messages in the file
+        std::sort(keys.begin(),keys.end());
+        return keys;
+    }
+
+    // Lower case words of US-ASCII letters and digits separated by single spaces
+    bool plain_words(std::string const &s)
+    {
+        if(s.empty() || s[0] == ' ' || s[s.size() - 1] == ' ')
+            return false;
+        for(size_t i = 0;i < s.size();i++) {
+            char c = s[i];
+            if(c == ' ' && s[i - 1] == ' ')
+                return false;
+            if(c != ' ' && !('a' <= c && c <= 'z') && !('0' <= c && c <= '9'))
+                return false;
+        }
+        return true;
+    }
+
+    // FNV-1a hash of the context and the id
+    unsigned long key_hash(key const &k)
+    {
+        std::string s = k.has_context ? k.context + '\4' + k.id : k.id;
+        unsigned long h = 2166136261UL;
+        for(size_t i = 0;i < s.size();i++) {
+            h ^= static_cast<unsigned char>(s[i]);
+            h = (h * 16777619UL) & 0xFFFFFFFFUL;
+        }
+        return h;
+    }
+
+    //
+    // C++ identifier of a key, it depends only on the key itself such that adding other messages to the
+    // catalog never changes the message an identifier refers to.
+    //
+    // Keys of lower case words are named after them losslessly, like msg_x_day for "x day" and
+    // msg_context__hello for "hello" in context "context". All other keys get the US-ASCII letters and
+    // digits of the key and the upper case hex digits of its hash, like msg_hello_H1A2B3C4D for "#hello".
+    // Lossless names have no upper case letters, so the names of different keys only collide if the
+    // hashes do, which is reported as an error.
+    //
+    std::string make_name(key const &k,std::set<std::string> &used)
+    {
+        static size_t const max_length = 48;
+        std::string words = k.has_context ? k.context + " " + k.id : k.id;
+        std::string name = "msg";
+        bool separate = true;
+        bool truncated = false;
+        for(size_t i = 0;i < words.size();i++) {
+            char c = words[i];
+            if(('a' <= c && c <= 'z') || ('0' <= c && c <= '9') || ('A' <= c && c <= 'Z')) {
+                if(name.size() >= max_length) {
+                    truncated = true;
+                    break;
+                }
+                if(separate)
+                    name += (k.has_context && i == k.context.size() + 1) ? "__" : "_";
+                name += ('A' <= c && c <= 'Z') ? char(c - 'A' + 'a') : c;
+                separate = false;
+            }
+            else
+                separate = true;
+        }
+        bool const lossless = !truncated && plain_words(k.id) && (!k.has_context || plain_words(k.context));
+        if(!lossless) {
+            std::ostringstream ss;
+            ss << name << "_H" << std::uppercase << std::hex;
+            ss.width(8);
+            ss.fill('0');
+            ss << key_hash(k);
+            name = ss.str();
+        }
+        if(!used.insert(name).second)
+            throw std::runtime_error("the identifier " + name + " is generated for several messages");
+        return name;
+    }
+
+    std::string literal(std::string const &s)
+    {
+        std::string result = "\"";
+        for(size_t i = 0;i < s.size();i++) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            switch(c) {
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            case '\r': result += "\\r"; break;
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '?': result += "\\?"; break; // No trigraphs
+            default:
+                if(c < 0x20 || c >= 0x7F) {
+                    // Octal escapes take at most 3 digits, so the following character can't be taken for one
+                    static char const digits[] = "01234567";
+                    result += '\\';
+                    result += digits[(c >> 6) & 7];
+                    result += digits[(c >> 3) & 7];
+                    result += digits[c & 7];
+                }
+                else
+                    result += char(c);
+            }
+        }
+        return result + "\"";
+    }
+
+    std::string generate(std::vector<key> const &keys,std::string const &ns,std::string const &source)
+    {
+        std::ostringstream out;
+        std::set<std::string> used;
+        std::string guard = ns;
+        std::transform(guard.begin(),guard.end(),guard.begin(),[](char c) { return c == ':' ? '_' : char(toupper(c)); });
+        out << "// Generated by message_ids from " << source << ", do not edit\n"
+            << "\n"
+            << "#ifndef " << guard << "_MESSAGE_IDS_HPP_INCLUDED\n"
+            << "#define " << guard << "_MESSAGE_IDS_HPP_INCLUDED\n"
+            << "\n"
+            << "#include <boost/locale/message_ids.hpp>\n"
+            << "\n"
+            << "namespace " << ns << " {\n"
+            << "\n"
+            << "    enum id {\n";
+        for(size_t i = 0;i < keys.size();i++)
+            out << "        " << make_name(keys[i],used) << " = " << i << ",\n";
+        out << "    };\n"
+            << "\n"
+            << "    static const boost::locale::message_id_key keys[" << std::max<size_t>(keys.size(),1) << "] = {\n";
+        for(size_t i = 0;i < keys.size();i++) {
+            key const &k = keys[i];
+            out << "        { "
+                << (k.has_context ? literal(k.context) : "0") << ", "
+                << literal(k.id) << ", "
+                << (k.plural.empty() ? "0" : literal(k.plural)) << " },\n";
+        }
+        out << "    };\n"
+            << "\n"
+            << "    static const boost::locale::message_id_table table(keys," << keys.size() << ");\n"
+            << "\n"
+            << "}\n"
+            << "\n"
+            << "#endif\n";
+        return out.str();
+    }
+
+    void usage()
+    {
+        std::cerr <<
+            "Usage: message_ids [-n namespace] input output\n"
+            "\n"
+            "Writes the C++ header output with integer ids of all messages of the\n"
+            "GNU gettext catalog input (.po, .pot or .mo file), usually the template\n"
+            "catalog created by xgettext. It defines in the namespace (\"messages\"\n"
+            "by default) the enum id of the ids and the boost::locale::message_id_table\n"
+            "table of the keys. The ids are assigned in the order of the sorted keys.\n"
+            "\n"
+            "The names of the ids depend only on their key: msg_x_day for \"x day\",\n"
+            "msg_context__hello for \"hello\" in the context \"context\". Keys that\n"
+            "aren't lower case words get a hash suffix, e.g. msg_hello_H1A2B3C4D\n"
+            "for \"#hello\".\n";
+    }
+
+} // anon
+
+int main(int argc,char **argv)
+{
+    std::string ns = "messages";
+    std::vector<std::string> files;
+    for(int i = 1;i < argc;i++) {
+        std::string arg = argv[i];
+        if(arg == "-n" && i + 1 < argc)
+            ns = argv[++i];
+        else if(arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        }
+        else
+            files.push_back(arg);
+    }
+    if(files.size() != 2) {
+        usage();
+        return 1;
+    }
+    try {
+        catalog cat;
+        read_catalog(read_file(files[0]),cat,true);
+        std::string name = files[0].substr(files[0].find_last_of("/\\") + 1);
+        std::string output = generate(get_keys(cat),ns,name);
+        std::ofstream f(files[1].c_str(),std::ios::binary);
+        f.write(output.data(),output.size());
+        if(!f)
+            throw std::runtime_error("failed to write " + files[1]);
+    }
+    catch(std::exception const &e) {
+        std::cerr << files[0] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}